@@ -91,11 +91,18 @@ namespace omtsched {
 
             OrderedComponent(const ID &id, const ID &type, const int &point) : Component<ID>{id, type}, point{point} {}
 
+            int getValue() const;
+
             friend bool operator<(const OrderedComponent<ID> &lhs, const OrderedComponent<ID> &rhs);
         private:
             int point;
         };
 
+    template<typename ID>
+    int OrderedComponent<ID>::getValue() const {
+        return point;
+    }
+
     template<typename ID>
     bool operator<(const OrderedComponent<ID> &lhs, const OrderedComponent<ID> &rhs) { return lhs.point < rhs.point; }
 
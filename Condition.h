@@ -8,6 +8,8 @@
 
 #include "ComponentType.h"
 #include "Component.h"
+#include "SmtWriter.h"
+#include "Fingerprint.h"
 
 namespace omtsched {
 
@@ -24,15 +26,28 @@ namespace omtsched {
 
     };
 
+        template<typename ID>
+        class Problem;
+
         template<typename ID>
         class Condition {
 
         public:
             Condition(std::vector<std::shared_ptr<Condition<ID>>> v = {}) : subconditions{v} {}
             virtual const CONDITION_TYPE getType() const = 0;
-            virtual void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const = 0;
+            /**
+             * Writes the condition as an SMT-LIB term with the same meaning as in the Z3 translator.
+             * @param asgn the assignment the condition is instantiated for, nullptr on the top level,
+             * where it holds for every (active) assignment
+             */
+            virtual void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn = nullptr) const = 0;
             //virtual returnType evaluate(std::vector<std::vector<Assignment<ID>*>>&) = 0;
-            virtual void declareVariables(std::ostream &, const std::vector<Assignment<ID>*> &) const;
+            virtual void declareVariables(SmtWriter &, const std::vector<Assignment<ID>*> &) const;
+            /**
+             * Adds the type, the subconditions and the parameters of the condition to the fingerprint,
+             * conditions with parameters extend it
+             */
+            virtual void fingerprint(Fingerprint &f) const;
             std::vector<std::shared_ptr<Condition<ID>>> subconditions = {};
 
         };
@@ -40,10 +55,62 @@ namespace omtsched {
 
 
     template<typename ID>
-    void Condition<ID>::declareVariables(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
+    void Condition<ID>::declareVariables(SmtWriter &, const std::vector<Assignment<ID>*> &) const {
         return;
     }
 
+    template<typename ID>
+    void Condition<ID>::fingerprint(Fingerprint &f) const {
+
+        f << getType() << subconditions.size();
+        for(const auto &subcondition : subconditions)
+            subcondition->fingerprint(f);
+    }
+
+    /*
+     * Names shared by Problem::print and the conditions:
+     * a[assignmentID]s[slotID] for slot variables, act[assignmentID] for the activation of optional assignments
+     */
+    template<typename ID>
+    SmtWriter &printSlot(SmtWriter &ostr, const ID &assignment, const ID &slot) {
+        return ostr.symbol("a", assignment, "s", slot);
+    }
+
+    template<typename ID>
+    SmtWriter &printActive(SmtWriter &ostr, const Assignment<ID> &asgn) {
+
+        if(!asgn.isOptional())
+            return ostr << "true";
+
+        return ostr.symbol("act", asgn.getID());
+    }
+
+    /*
+     * Top level conditions: (and ...) over all assignments with the slot,
+     * instances for optional assignments only have to hold while they are active
+     */
+    template<typename ID, typename Instance>
+    void printForAll(SmtWriter &ostr, const Problem<ID> &problem, const ID &slot, const Instance &instance) {
+
+        ostr << "(and true";
+        for(const auto &[id, asgn] : problem.getAssignments()) {
+
+            if(!asgn.getComponentSlots().count(slot))
+                continue;
+
+            ostr << ' ';
+            if(asgn.isOptional()) {
+                ostr << "(=> ";
+                printActive(ostr, asgn) << ' ';
+                instance(asgn);
+                ostr << ')';
+            }
+            else
+                instance(asgn);
+        }
+        ostr << ')';
+    }
+
     /*
     template<typename ID, typename returnType>
     class CompositeCondition : public Condition<ID, returnType> {
@@ -67,6 +134,8 @@ namespace omtsched {
 
         const ID getNamedSlot() const;
 
+        void fingerprint(Fingerprint &f) const override;
+
     protected:
         static int counter;
 
@@ -79,6 +148,13 @@ namespace omtsched {
         return componentSlot;
     }
 
+    template<typename ID>
+    void NamedCondition<ID>::fingerprint(Fingerprint &f) const {
+
+        Condition<ID>::fingerprint(f);
+        f << componentSlot;
+    }
+
     template<typename ID>
     int NamedCondition<ID>::counter = 0;
 
@@ -0,0 +1,118 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_EXPLANATION_H
+#define OMTSCHED_EXPLANATION_H
+
+#include "Problem.h"
+#include "Rule.h"
+
+namespace omtsched {
+
+    /*
+     * Why a problem has no model: rules and fixed slots that cannot hold together.
+     * Component types, components and the slot domains are always part of the background.
+     */
+    template<typename ID>
+    class Explanation {
+
+    public:
+        /**
+         * @param handle position of the rule, the problem's rules come first followed by those added to the translator
+         */
+        void addRule(const size_t &handle, const Rule<ID> &rule);
+
+        void addFixedSlot(const ID &assignment, const ID &slot, const ID &component);
+
+        const std::map<size_t, Rule<ID>> &getRules() const;
+
+        /**
+         * @return the component of every fixed slot in the explanation by (assignment, slot)
+         */
+        const std::map<std::pair<ID, ID>, ID> &getFixedSlots() const;
+
+        /**
+         * @return the assignments whose fixed slots are part of the explanation
+         */
+        std::set<ID> getAssignments() const;
+
+        /**
+         * Minimal explanations stay satisfiable if any one of their rules or fixed slots is dropped
+         */
+        void setMinimal(const bool &minimal);
+
+        bool isMinimal() const;
+
+        bool isEmpty() const;
+
+        void print(std::ostream &ostr) const;
+
+    private:
+        std::map<size_t, Rule<ID>> rules;
+        std::map<std::pair<ID, ID>, ID> fixedSlots;
+        bool minimal = false;
+    };
+
+    template<typename ID>
+    void Explanation<ID>::addRule(const size_t &handle, const Rule<ID> &rule) {
+        rules.emplace(handle, rule);
+    }
+
+    template<typename ID>
+    void Explanation<ID>::addFixedSlot(const ID &assignment, const ID &slot, const ID &component) {
+        fixedSlots[std::make_pair(assignment, slot)] = component;
+    }
+
+    template<typename ID>
+    const std::map<size_t, Rule<ID>> &Explanation<ID>::getRules() const {
+        return rules;
+    }
+
+    template<typename ID>
+    const std::map<std::pair<ID, ID>, ID> &Explanation<ID>::getFixedSlots() const {
+        return fixedSlots;
+    }
+
+    template<typename ID>
+    std::set<ID> Explanation<ID>::getAssignments() const {
+
+        std::set<ID> assignments;
+        for(const auto &[slot, component] : fixedSlots)
+            assignments.insert(slot.first);
+
+        return assignments;
+    }
+
+    template<typename ID>
+    void Explanation<ID>::setMinimal(const bool &minimal) {
+        Explanation::minimal = minimal;
+    }
+
+    template<typename ID>
+    bool Explanation<ID>::isMinimal() const {
+        return minimal;
+    }
+
+    template<typename ID>
+    bool Explanation<ID>::isEmpty() const {
+        return rules.empty() && fixedSlots.empty();
+    }
+
+    template<typename ID>
+    void Explanation<ID>::print(std::ostream &ostr) const {
+
+        ostr << "EXPLANATION START" << (minimal ? " (minimal)" : "") << std::endl;
+
+        for(const auto &[handle, rule] : rules)
+            ostr << "rule " << handle << (rule.isOptional() ? " (soft)" : "") << std::endl;
+
+        for(const auto &[slot, component] : fixedSlots)
+            ostr << "(" << slot.first << ", " << slot.second << ") fixed to " << component << std::endl;
+
+        ostr << "EXPLANATION END" << std::endl;
+    }
+
+}
+
+#endif //OMTSCHED_EXPLANATION_H
@@ -0,0 +1,91 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_FINGERPRINT_H
+#define OMTSCHED_FINGERPRINT_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace omtsched {
+
+    /*
+     * 64 bit FNV-1a hash of a sequence of values.
+     * Integers are hashed as 8 bytes in little endian order and text with its length in front,
+     * so the value does not depend on the platform and ("ab", "c") differs from ("a", "bc").
+     * A second hash of the same bytes with a multiply-xorshift step tells apart sequences whose FNV values collide.
+     */
+    class Fingerprint {
+
+    public:
+        /**
+         * Integers and text as described above, everything else as the text of its operator<<
+         */
+        template<typename T>
+        Fingerprint &operator<<(const T &value);
+
+        uint64_t getValue() const;
+
+        /**
+         * @return the second hash, independent of getValue
+         */
+        uint64_t getCheck() const;
+
+    private:
+        void mix(const unsigned char &byte);
+        void mixInteger(const uint64_t &value);
+
+        uint64_t hash = 14695981039346656037ull;
+        uint64_t check = 0x243f6a8885a308d3ull;
+    };
+
+    template<typename T>
+    Fingerprint &Fingerprint::operator<<(const T &value) {
+
+        if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            mixInteger((uint64_t) (int64_t) value);
+        else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            const std::string_view text = value;
+            mixInteger(text.size());
+            for(const char &c : text)
+                mix((unsigned char) c);
+        }
+        else {
+            std::ostringstream text;
+            text << value;
+            *this << text.str();
+        }
+
+        return *this;
+    }
+
+    inline uint64_t Fingerprint::getValue() const {
+        return hash;
+    }
+
+    inline uint64_t Fingerprint::getCheck() const {
+        return check;
+    }
+
+    inline void Fingerprint::mix(const unsigned char &byte) {
+
+        hash ^= byte;
+        hash *= 1099511628211ull;
+
+        check = (check ^ byte) * 0x9e3779b97f4a7c15ull;
+        check ^= check >> 29;
+    }
+
+    inline void Fingerprint::mixInteger(const uint64_t &value) {
+
+        for(size_t i = 0; i < 8; i++)
+            mix((unsigned char) (value >> (8 * i)));
+    }
+
+}
+
+#endif //OMTSCHED_FINGERPRINT_H
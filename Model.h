@@ -6,6 +6,7 @@
 #define OMTSCHED_MODEL_H
 
 #include "Problem.h"
+#include <optional>
 
 namespace omtsched {
 
@@ -17,30 +18,86 @@ namespace omtsched {
     public:
         void setComponent(const ID &assignment, const ID &slot, const ID &component);
 
-        const ID &getComponent(const ID &assignment, const ID &slot);
+        const ID &getComponent(const ID &assignment, const ID &slot) const;
+
+        bool hasComponent(const ID &assignment, const ID &slot) const;
+
+        /**
+         * @return the component of every slot by (assignment, slot)
+         */
+        const std::map<std::pair<ID, ID>, ID> &getComponents() const;
 
         void addPenalty(const int &);
 
         int getPenalty() const;
 
+        /**
+         * Records a violated soft rule, its weight is added to the penalty
+         * @param rule handle of the rule (its position in the problem's rules)
+         * @param weight the rule's weight
+         */
+        void addViolation(const size_t &rule, const int &weight);
+
+        /**
+         * @return the weight of every violated soft rule by rule handle
+         */
+        const std::map<size_t, int> &getViolations() const;
+
+        /**
+         * Records an optional assignment that was left unfilled, its weight is added to the penalty.
+         * Unfilled assignments have no components.
+         */
+        void addUnfilled(const ID &assignment, const int &weight);
+
+        bool isFilled(const ID &assignment) const;
+
+        /**
+         * Records a proven lower bound on the penalty of every model of the problem,
+         * the model is optimal if it equals the penalty
+         */
+        void setLowerBound(const int &bound);
+
+        /**
+         * @return the lower bound, empty if none was proven
+         */
+        std::optional<int> getLowerBound() const;
+
         void print(std::ostream &ostr) const;
 
     private:
         // map between (assignment, slotName) and components
         std::map<std::pair<ID, ID>, ID> assignments;
-        int penalty;
+        int penalty = 0;
+        std::map<size_t, int> violations;
+        std::set<ID> unfilled;
+        std::optional<int> lowerBound;
     };
 
     template<typename ID>
     void Model<ID>::setComponent(const ID &assignment, const ID &slot, const ID &component) {
-        assignments[std::make_pair(assignment, slot)] = component;
+
+        // models are mostly filled in the order of the problem, appending needs no search
+        if(assignments.empty() || assignments.rbegin()->first < std::make_pair(assignment, slot))
+            assignments.emplace_hint(assignments.end(), std::make_pair(assignment, slot), component);
+        else
+            assignments[std::make_pair(assignment, slot)] = component;
     }
 
     template<typename ID>
-    const ID &Model<ID>::getComponent(const ID &assignment, const ID &slot) {
+    const ID &Model<ID>::getComponent(const ID &assignment, const ID &slot) const {
         return assignments.at(std::make_pair(assignment, slot));
     }
 
+    template<typename ID>
+    bool Model<ID>::hasComponent(const ID &assignment, const ID &slot) const {
+        return assignments.count(std::make_pair(assignment, slot));
+    }
+
+    template<typename ID>
+    const std::map<std::pair<ID, ID>, ID> &Model<ID>::getComponents() const {
+        return assignments;
+    }
+
     template<typename ID>
     void Model<ID>::addPenalty(const int &p) {
         penalty += p;
@@ -51,13 +108,56 @@ namespace omtsched {
         return penalty;
     }
 
+    template<typename ID>
+    void Model<ID>::addViolation(const size_t &rule, const int &weight) {
+        violations[rule] += weight;
+        penalty += weight;
+    }
+
+    template<typename ID>
+    const std::map<size_t, int> &Model<ID>::getViolations() const {
+        return violations;
+    }
+
+    template<typename ID>
+    void Model<ID>::addUnfilled(const ID &assignment, const int &weight) {
+        unfilled.insert(assignment);
+        penalty += weight;
+    }
+
+    template<typename ID>
+    bool Model<ID>::isFilled(const ID &assignment) const {
+        return !unfilled.count(assignment);
+    }
+
+    template<typename ID>
+    void Model<ID>::setLowerBound(const int &bound) {
+        lowerBound = bound;
+    }
+
+    template<typename ID>
+    std::optional<int> Model<ID>::getLowerBound() const {
+        return lowerBound;
+    }
+
     template<typename ID>
     void Model<ID>::print(std::ostream &ostr) const {
 
-        ostr << "MODEL START" << std::endl;
+        ostr << "MODEL START\n";
         // std::map<std::pair<ID, ID>, ID> assignments;
         for(const auto &[pair, assigned] : assignments)
-            ostr << "(" << pair.first << ", " << pair.second << ") -> " << assigned << std::endl;
+            ostr << "(" << pair.first << ", " << pair.second << ") -> " << assigned << '\n';
+
+        if(penalty != 0 || !violations.empty()) {
+            ostr << "PENALTY " << penalty << '\n';
+            for(const auto &[rule, weight] : violations)
+                ostr << "rule " << rule << " violated: " << weight << '\n';
+            for(const ID &assignment : unfilled)
+                ostr << "assignment " << assignment << " unfilled" << '\n';
+        }
+
+        if(lowerBound)
+            ostr << "LOWER BOUND " << *lowerBound << '\n';
 
         ostr << "MODEL END" << std::endl;
     }
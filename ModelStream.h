@@ -0,0 +1,841 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_MODELSTREAM_H
+#define OMTSCHED_MODELSTREAM_H
+
+#include "Problem.h"
+#include "Model.h"
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * Formats of ModelWriter and ModelReader, both hold any number of models one after another.
+     * BINARY:     a header with the fingerprint of the problem, then per model varints of the penalty,
+     *             the lower bound, the unfilled assignments, the component of every slot by its position
+     *             among the components of the type and the violated rules with their weights
+     * JSON_LINES: one JSON object per model and line, IDs as text, e.g.
+     *             {"penalty":3,"lower":1,"unfilled":["a2"],"violations":[{"rule":0,"weight":2}],"slots":{"a1":{"s":"c4"}}}
+     * Assignments and slots are listed in the order of the problem, both formats need the same problem to be read.
+     */
+    enum class MODEL_FORMAT {
+        BINARY, JSON_LINES
+    };
+
+    /*
+     * The positions and names of a problem's assignments, slots and components, shared by ModelWriter and ModelReader
+     */
+    template<typename ID>
+    class ModelStream {
+    protected:
+        ModelStream(const Problem<ID> &problem, const MODEL_FORMAT &format);
+
+        static std::string text(const ID &id);
+
+        /*
+         * Walks the slots of a model alongside the problem: both order them by (assignment, slot),
+         * so finding the component of each slot in turn needs no lookup
+         */
+        class Cursor {
+        public:
+            explicit Cursor(const Model<ID> &model) : value{model.getComponents().begin()}, end{model.getComponents().end()} {}
+
+            // the component of the slot, nullptr if the model has none, slots have to be asked in order
+            const ID *find(const ID &assignment, const ID &slot);
+
+        private:
+            typename std::map<std::pair<ID, ID>, ID>::const_iterator value;
+            const typename std::map<std::pair<ID, ID>, ID>::const_iterator end;
+        };
+
+        // the first bytes of a binary stream, followed by the problem's fingerprint
+        static constexpr char magic[5] = {'O', 'M', 'T', 'M', 1};
+
+        const Problem<ID> &problem;
+        const MODEL_FORMAT format;
+
+        std::vector<const Assignment<ID> *> assignments;
+        // position of every component among the components of its type, per type
+        std::map<ID, std::map<ID, size_t>> ordinals;
+    };
+
+    /*
+     * Appends models to a stream. The text is collected in a buffer that is handed to the stream in large blocks,
+     * a model is never copied, so models with millions of slots only cost their encoded size.
+     */
+    template<typename ID>
+    class ModelWriter : protected ModelStream<ID> {
+    public:
+        ModelWriter(const Problem<ID> &problem, std::ostream &ostr, const MODEL_FORMAT &format = MODEL_FORMAT::BINARY);
+
+        ModelWriter(const ModelWriter &) = delete;
+        ModelWriter &operator=(const ModelWriter &) = delete;
+
+        ~ModelWriter();
+
+        /**
+         * Appends the model, it has to be a model of the problem
+         */
+        void write(const Model<ID> &model);
+
+        /**
+         * Hands everything written so far to the stream
+         */
+        void flush();
+
+        /**
+         * @return number of models written
+         */
+        size_t getCount() const;
+
+    private:
+
+        void writeBinary(const Model<ID> &model);
+        void writeJson(const Model<ID> &model);
+
+        // hands the buffer to the stream without flushing it
+        void drain();
+
+        void putVarint(uint64_t value);
+        void putSigned(const int64_t &value);
+
+        // the text as a JSON string with quotes
+        static std::string quote(const std::string &text);
+
+        std::ostream &ostr;
+        std::string buffer;
+        size_t count = 0;
+
+        // JSON only: the quoted names of the IDs
+        std::vector<std::string> assignmentNames;
+        std::map<ID, std::string> names;
+    };
+
+    /*
+     * Reads models one at a time from a stream written by ModelWriter for the same problem
+     */
+    template<typename ID>
+    class ModelReader : protected ModelStream<ID> {
+    public:
+        ModelReader(const Problem<ID> &problem, std::istream &istr, const MODEL_FORMAT &format = MODEL_FORMAT::BINARY);
+
+        /**
+         * @return the next model, empty at the end of the stream
+         */
+        std::optional<Model<ID>> read();
+
+        /**
+         * @return false if the stream does not belong to the problem or a model could not be decoded,
+         * read returns nothing from then on
+         */
+        bool isValid() const;
+
+    private:
+
+        // a position in one line of JSON
+        class JsonCursor {
+        public:
+            explicit JsonCursor(const std::string &text) : text{text} {}
+
+            bool consume(const char &c);
+            void expect(const char &c);
+            std::string string();
+            int64_t number();
+            // skips a value of a member that is not known
+            void value();
+            bool isAtEnd();
+
+            // marks the line as malformed and moves to its end, the reader stops there
+            void fail();
+            bool isFailed() const;
+
+        private:
+            void skipSpace();
+
+            const std::string &text;
+            size_t pos = 0;
+            bool failed = false;
+        };
+
+        std::optional<Model<ID>> readBinary();
+        std::optional<Model<ID>> readJson();
+
+        // false at the end of the stream, which is only expected before a model, or if the varint is malformed
+        bool getVarint(uint64_t &value);
+        uint64_t varint();
+        int64_t getSigned();
+
+        // the model's penalty is the sum of its parts plus what was recorded beyond them
+        static void setPenalty(Model<ID> &model, const int64_t &penalty);
+
+        std::istream &istr;
+        bool valid = true;
+
+        // JSON only: the IDs by their text
+        std::map<std::string, const Assignment<ID> *> assignmentsByName;
+        std::map<std::string, ID> slotsByName;
+        std::map<ID, std::map<std::string, ID>> componentsByName;
+    };
+
+    template<typename ID>
+    ModelStream<ID>::ModelStream(const Problem<ID> &problem, const MODEL_FORMAT &format) : problem{problem}, format{format} {
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            assignments.push_back(&asgn);
+
+        for(const ID &type : problem.getComponentTypes()) {
+            const auto &components = problem.getComponents(type);
+            for(size_t i = 0; i < components.size(); i++)
+                ordinals[type].emplace(components.at(i)->getID(), i);
+        }
+    }
+
+    template<typename ID>
+    std::string ModelStream<ID>::text(const ID &id) {
+
+        std::ostringstream text;
+        text << id;
+        return text.str();
+    }
+
+    template<typename ID>
+    const ID *ModelStream<ID>::Cursor::find(const ID &assignment, const ID &slot) {
+
+        // skips slots the problem does not have
+        while(value != end && (value->first.first < assignment || (value->first.first == assignment && value->first.second < slot)))
+            ++value;
+
+        if(value == end || !(value->first.first == assignment && value->first.second == slot))
+            return nullptr;
+
+        return &(value++)->second;
+    }
+
+    template<typename ID>
+    ModelWriter<ID>::ModelWriter(const Problem<ID> &problem, std::ostream &ostr, const MODEL_FORMAT &format) :
+    ModelStream<ID>{problem, format}, ostr{ostr} {
+
+        if(format == MODEL_FORMAT::BINARY) {
+            buffer.append(this->magic, sizeof(this->magic));
+            const uint64_t fingerprint = problem.getFingerprint();
+            for(size_t i = 0; i < 8; i++)
+                buffer.push_back((char) (fingerprint >> (8 * i)));
+            return;
+        }
+
+        for(const Assignment<ID> *asgn : this->assignments) {
+            assignmentNames.push_back(quote(this->text(asgn->getID())));
+            for(const auto &[sid, slot] : asgn->getComponentSlots())
+                if(!names.count(sid))
+                    names.emplace(sid, quote(this->text(sid)));
+        }
+
+        for(const ID &type : problem.getComponentTypes())
+            for(const auto &component : problem.getComponents(type))
+                names.emplace(component->getID(), quote(this->text(component->getID())));
+    }
+
+    template<typename ID>
+    ModelWriter<ID>::~ModelWriter() {
+        flush();
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::write(const Model<ID> &model) {
+
+        if(this->format == MODEL_FORMAT::BINARY)
+            writeBinary(model);
+        else
+            writeJson(model);
+
+        count++;
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::flush() {
+
+        drain();
+        ostr.flush();
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::drain() {
+
+        ostr.write(buffer.data(), (std::streamsize) buffer.size());
+        buffer.clear();
+    }
+
+    template<typename ID>
+    size_t ModelWriter<ID>::getCount() const {
+        return count;
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::writeBinary(const Model<ID> &model) {
+
+        putVarint(model.getLowerBound() ? 1 : 0);
+        putSigned(model.getPenalty());
+        if(model.getLowerBound())
+            putSigned(*model.getLowerBound());
+
+        // positions of the unfilled assignments, each as the distance to the previous one
+        std::vector<size_t> unfilled;
+        for(size_t a = 0; a < this->assignments.size(); a++)
+            if(!model.isFilled(this->assignments.at(a)->getID()))
+                unfilled.push_back(a);
+
+        putVarint(unfilled.size());
+        for(size_t i = 0; i < unfilled.size(); i++)
+            putVarint(unfilled.at(i) - (i > 0 ? unfilled.at(i - 1) : 0));
+
+        // position of the component + 1 for every slot of a filled assignment, 0 if the slot is empty
+        typename ModelStream<ID>::Cursor value {model};
+
+        for(const Assignment<ID> *asgn : this->assignments) {
+
+            if(!model.isFilled(asgn->getID()))
+                continue;
+
+            for(const auto &[sid, slot] : asgn->getComponentSlots()) {
+                const ID *component = value.find(asgn->getID(), sid);
+                putVarint(component ? this->ordinals.at(slot.type).at(*component) + 1 : 0);
+            }
+
+            if(buffer.size() >= 1 << 16)
+                drain();
+        }
+
+        putVarint(model.getViolations().size());
+        size_t previous = 0;
+        for(const auto &[handle, weight] : model.getViolations()) {
+            putVarint(handle - previous);
+            putSigned(weight);
+            previous = handle;
+        }
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::writeJson(const Model<ID> &model) {
+
+        buffer += "{\"penalty\":" + std::to_string(model.getPenalty());
+        if(model.getLowerBound())
+            buffer += ",\"lower\":" + std::to_string(*model.getLowerBound());
+
+        buffer += ",\"unfilled\":[";
+        bool first = true;
+        for(size_t a = 0; a < this->assignments.size(); a++)
+            if(!model.isFilled(this->assignments.at(a)->getID())) {
+                buffer += first ? "" : ",";
+                buffer += assignmentNames.at(a);
+                first = false;
+            }
+
+        buffer += "],\"violations\":[";
+        first = true;
+        for(const auto &[handle, weight] : model.getViolations()) {
+            buffer += first ? "" : ",";
+            buffer += "{\"rule\":" + std::to_string(handle) + ",\"weight\":" + std::to_string(weight) + "}";
+            first = false;
+        }
+
+        buffer += "],\"slots\":{";
+        first = true;
+        typename ModelStream<ID>::Cursor value {model};
+        for(size_t a = 0; a < this->assignments.size(); a++) {
+
+            const Assignment<ID> &asgn = *this->assignments.at(a);
+            if(!model.isFilled(asgn.getID()))
+                continue;
+
+            buffer += first ? "" : ",";
+            buffer += assignmentNames.at(a) + ":{";
+            first = false;
+
+            bool firstSlot = true;
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                const ID *component = value.find(asgn.getID(), sid);
+                if(!component)
+                    continue;
+
+                buffer += firstSlot ? "" : ",";
+                buffer += names.at(sid);
+                buffer += ':';
+                buffer += names.at(*component);
+                firstSlot = false;
+            }
+
+            buffer += "}";
+
+            if(buffer.size() >= 1 << 16)
+                drain();
+        }
+
+        buffer += "}}\n";
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::putVarint(uint64_t value) {
+
+        // 7 bits per byte, the high bit marks that more bytes follow
+        while(value >= 0x80) {
+            buffer.push_back((char) (value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back((char) value);
+    }
+
+    template<typename ID>
+    void ModelWriter<ID>::putSigned(const int64_t &value) {
+
+        // zigzag: small negative numbers stay short
+        putVarint(((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+    }
+
+    template<typename ID>
+    std::string ModelWriter<ID>::quote(const std::string &text) {
+
+        static const char hex[] = "0123456789abcdef";
+
+        std::string quoted = "\"";
+        for(const char &c : text) {
+            if(c == '"' || c == '\\')
+                quoted += {'\\', c};
+            else if((unsigned char) c < 0x20)
+                quoted += {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+            else
+                quoted += c;
+        }
+
+        return quoted + "\"";
+    }
+
+    template<typename ID>
+    ModelReader<ID>::ModelReader(const Problem<ID> &problem, std::istream &istr, const MODEL_FORMAT &format) :
+    ModelStream<ID>{problem, format}, istr{istr} {
+
+        if(format == MODEL_FORMAT::BINARY) {
+
+            char header[sizeof(this->magic) + 8];
+            istr.read(header, sizeof(header));
+
+            uint64_t fingerprint = 0;
+            for(size_t i = 0; i < 8; i++)
+                fingerprint |= (uint64_t) (unsigned char) header[sizeof(this->magic) + i] << (8 * i);
+
+            valid = istr.gcount() == (std::streamsize) sizeof(header) &&
+                    std::equal(this->magic, this->magic + sizeof(this->magic), header) &&
+                    fingerprint == problem.getFingerprint();
+            return;
+        }
+
+        for(const Assignment<ID> *asgn : this->assignments) {
+            assignmentsByName.emplace(this->text(asgn->getID()), asgn);
+            for(const auto &[sid, slot] : asgn->getComponentSlots())
+                slotsByName.emplace(this->text(sid), sid);
+        }
+
+        for(const ID &type : problem.getComponentTypes())
+            for(const auto &component : problem.getComponents(type))
+                componentsByName[type].emplace(this->text(component->getID()), component->getID());
+    }
+
+    template<typename ID>
+    std::optional<Model<ID>> ModelReader<ID>::read() {
+
+        if(!valid)
+            return std::nullopt;
+
+        return this->format == MODEL_FORMAT::BINARY ? readBinary() : readJson();
+    }
+
+    template<typename ID>
+    bool ModelReader<ID>::isValid() const {
+        return valid;
+    }
+
+    template<typename ID>
+    std::optional<Model<ID>> ModelReader<ID>::readBinary() {
+
+        uint64_t flags;
+        if(!getVarint(flags))
+            return std::nullopt;
+
+        Model<ID> model;
+
+        const int64_t penalty = getSigned();
+        if(flags & 1)
+            model.setLowerBound((int) getSigned());
+
+        // positions, components and rules out of range are decode errors like a truncated stream
+        std::vector<bool> unfilled(this->assignments.size(), false);
+        size_t position = 0;
+        for(uint64_t i = varint(); i > 0 && valid; i--) {
+            const uint64_t distance = varint();
+            if(!valid || distance >= unfilled.size() - position || unfilled.at(position + distance)) {
+                valid = false;
+                break;
+            }
+
+            position += distance;
+            const Assignment<ID> &asgn = *this->assignments.at(position);
+            unfilled.at(position) = true;
+            model.addUnfilled(asgn.getID(), asgn.getWeight());
+        }
+
+        for(size_t a = 0; a < this->assignments.size() && valid; a++) {
+
+            if(unfilled.at(a))
+                continue;
+
+            const Assignment<ID> &asgn = *this->assignments.at(a);
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                const uint64_t component = varint();
+                const auto &components = this->problem.getComponents(slot.type);
+                if(!valid || component > components.size()) {
+                    valid = false;
+                    break;
+                }
+
+                if(component > 0)
+                    model.setComponent(asgn.getID(), sid, components.at(component - 1)->getID());
+            }
+        }
+
+        const size_t rules = this->problem.getRules().size();
+        size_t handle = 0;
+        for(uint64_t i = varint(); i > 0 && valid; i--) {
+            const uint64_t distance = varint();
+            if(!valid || distance >= rules - handle) {
+                valid = false;
+                break;
+            }
+
+            handle += distance;
+            model.addViolation(handle, (int) getSigned());
+        }
+
+        if(!valid)
+            return std::nullopt;
+
+        setPenalty(model, penalty);
+        return model;
+    }
+
+    template<typename ID>
+    std::optional<Model<ID>> ModelReader<ID>::readJson() {
+
+        std::string line;
+        while(std::getline(istr, line) && line.find_first_not_of(" \t\r") == std::string::npos);
+
+        if(line.find_first_not_of(" \t\r") == std::string::npos)
+            return std::nullopt;
+
+        Model<ID> model;
+        int64_t penalty = 0;
+
+        JsonCursor json {line};
+        json.expect('{');
+
+        // the members of an object or the elements of an array up to the closing bracket
+        const auto more = [&](const char &close) { return !json.consume(close) && !json.isAtEnd(); };
+
+        bool closed = false;
+        while(!(closed = json.consume('}')) && !json.isAtEnd()) {
+
+            const std::string key = json.string();
+            json.expect(':');
+
+            if(key == "penalty")
+                penalty = json.number();
+            else if(key == "lower")
+                model.setLowerBound((int) json.number());
+            else if(key == "unfilled") {
+                json.expect('[');
+                while(more(']')) {
+                    const auto asgn = assignmentsByName.find(json.string());
+                    if(asgn == assignmentsByName.end()) {
+                        json.fail();
+                        break;
+                    }
+
+                    model.addUnfilled(asgn->second->getID(), asgn->second->getWeight());
+                    json.consume(',');
+                }
+            }
+            else if(key == "violations") {
+                json.expect('[');
+                while(more(']')) {
+                    json.expect('{');
+                    int64_t handle = 0, weight = 0;
+                    while(more('}')) {
+                        const std::string field = json.string();
+                        json.expect(':');
+                        if(field == "rule")
+                            handle = json.number();
+                        else if(field == "weight")
+                            weight = json.number();
+                        else
+                            json.value();
+                        json.consume(',');
+                    }
+                    if(handle < 0 || handle >= (int64_t) this->problem.getRules().size()) {
+                        json.fail();
+                        break;
+                    }
+
+                    model.addViolation((size_t) handle, (int) weight);
+                    json.consume(',');
+                }
+            }
+            else if(key == "slots") {
+                json.expect('{');
+                while(more('}')) {
+                    const auto asgn = assignmentsByName.find(json.string());
+                    if(asgn == assignmentsByName.end()) {
+                        json.fail();
+                        break;
+                    }
+
+                    json.expect(':');
+                    json.expect('{');
+                    while(more('}')) {
+
+                        // the slot has to belong to the assignment and the component to the slot's type
+                        const auto sid = slotsByName.find(json.string());
+                        const auto &slots = asgn->second->getComponentSlots();
+                        const auto slot = sid != slotsByName.end() ? slots.find(sid->second) : slots.end();
+                        json.expect(':');
+                        const std::string name = json.string();
+
+                        if(slot == slots.end() || !componentsByName.count(slot->second.type) ||
+                           !componentsByName.at(slot->second.type).count(name)) {
+                            json.fail();
+                            break;
+                        }
+
+                        model.setComponent(asgn->second->getID(), slot->first, componentsByName.at(slot->second.type).at(name));
+                        json.consume(',');
+                    }
+                    json.consume(',');
+                }
+            }
+            else
+                json.value();
+
+            json.consume(',');
+        }
+
+        if(!closed || json.isFailed()) {
+            valid = false;
+            return std::nullopt;
+        }
+
+        setPenalty(model, penalty);
+        return model;
+    }
+
+    template<typename ID>
+    bool ModelReader<ID>::getVarint(uint64_t &value) {
+
+        std::streambuf &in = *istr.rdbuf();
+
+        value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7) {
+
+            const auto byte = in.sbumpc();
+            if(byte == std::streambuf::traits_type::eof()) {
+                // the end of the stream is only expected before a model
+                if(shift > 0)
+                    valid = false;
+                return false;
+            }
+
+            value |= (uint64_t) (byte & 0x7f) << shift;
+            if(!(byte & 0x80))
+                return true;
+        }
+
+        valid = false;
+        return false;
+    }
+
+    template<typename ID>
+    uint64_t ModelReader<ID>::varint() {
+
+        uint64_t value = 0;
+        if(!getVarint(value))
+            valid = false;
+
+        return value;
+    }
+
+    template<typename ID>
+    int64_t ModelReader<ID>::getSigned() {
+
+        const uint64_t value = varint();
+        return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+    }
+
+    template<typename ID>
+    void ModelReader<ID>::setPenalty(Model<ID> &model, const int64_t &penalty) {
+        model.addPenalty((int) penalty - model.getPenalty());
+    }
+
+    template<typename ID>
+    bool ModelReader<ID>::JsonCursor::consume(const char &c) {
+
+        skipSpace();
+        if(pos < text.size() && text.at(pos) == c) {
+            pos++;
+            return true;
+        }
+
+        return false;
+    }
+
+    template<typename ID>
+    void ModelReader<ID>::JsonCursor::expect(const char &c) {
+
+        if(!consume(c))
+            fail();
+    }
+
+    template<typename ID>
+    std::string ModelReader<ID>::JsonCursor::string() {
+
+        std::string result;
+        expect('"');
+
+        while(pos < text.size() && text.at(pos) != '"') {
+
+            if(text.at(pos) != '\\') {
+                result += text.at(pos++);
+                continue;
+            }
+
+            const char escaped = pos + 1 < text.size() ? text.at(pos + 1) : '\\';
+            pos += 2;
+
+            switch(escaped) {
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    // UTF-8 of a code point in the basic plane
+                    unsigned code = 0;
+                    if(pos + 4 > text.size() || std::from_chars(text.data() + pos, text.data() + pos + 4, code, 16).ptr != text.data() + pos + 4) {
+                        fail();
+                        return result;
+                    }
+                    pos += 4;
+                    if(code < 0x80)
+                        result += (char) code;
+                    else if(code < 0x800)
+                        result += {(char) (0xc0 | (code >> 6)), (char) (0x80 | (code & 0x3f))};
+                    else
+                        result += {(char) (0xe0 | (code >> 12)), (char) (0x80 | ((code >> 6) & 0x3f)), (char) (0x80 | (code & 0x3f))};
+                    break;
+                }
+                default: result += escaped;
+            }
+        }
+
+        if(pos >= text.size())
+            fail();
+
+        pos++;
+        return result;
+    }
+
+    template<typename ID>
+    int64_t ModelReader<ID>::JsonCursor::number() {
+
+        skipSpace();
+
+        const size_t start = pos;
+        while(pos < text.size() && (text.at(pos) == '-' || (text.at(pos) >= '0' && text.at(pos) <= '9')))
+            pos++;
+
+        int64_t value = 0;
+        const auto [end, error] = std::from_chars(text.data() + start, text.data() + pos, value);
+        if(pos == start || end != text.data() + pos || error != std::errc())
+            fail();
+
+        return value;
+    }
+
+    template<typename ID>
+    void ModelReader<ID>::JsonCursor::value() {
+
+        skipSpace();
+        if(pos >= text.size())
+            return;
+
+        if(text.at(pos) == '"') {
+            string();
+            return;
+        }
+
+        // objects and arrays up to their closing bracket, strings may contain brackets
+        int depth = 0;
+        while(pos < text.size()) {
+
+            const char c = text.at(pos);
+            if(c == '"') {
+                string();
+                continue;
+            }
+            if(depth == 0 && (c == ',' || c == '}' || c == ']'))
+                return;
+
+            depth += (c == '{' || c == '[') - (c == '}' || c == ']');
+            pos++;
+
+            if(depth == 0 && (c == '}' || c == ']'))
+                return;
+        }
+    }
+
+    template<typename ID>
+    bool ModelReader<ID>::JsonCursor::isAtEnd() {
+
+        skipSpace();
+        return pos >= text.size();
+    }
+
+    template<typename ID>
+    void ModelReader<ID>::JsonCursor::fail() {
+
+        failed = true;
+        pos = text.size();
+    }
+
+    template<typename ID>
+    bool ModelReader<ID>::JsonCursor::isFailed() const {
+        return failed;
+    }
+
+    template<typename ID>
+    void ModelReader<ID>::JsonCursor::skipSpace() {
+
+        while(pos < text.size() && (text.at(pos) == ' ' || text.at(pos) == '\t' || text.at(pos) == '\r'))
+            pos++;
+    }
+
+}
+
+#endif //OMTSCHED_MODELSTREAM_H
@@ -9,11 +9,25 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <stdexcept>
 #include "Assignment.h"
 #include "Rule.h"
 
 namespace omtsched {
 
+    /*
+     * How Problem::print states the cost of soft rules and unfilled optional assignments.
+     * ASSERT_SOFT: one assert-soft with :weight per soft rule and optional assignment, all under :id penalty
+     * MINIMIZE:    a single (minimize ...) over the summed weights, for solvers without assert-soft
+     */
+    enum class SMT_OBJECTIVE {
+        ASSERT_SOFT, MINIMIZE
+    };
+
     template<typename ID>
     class Problem {
 
@@ -22,10 +36,38 @@ namespace omtsched {
        /**
         * Outputs the problem formulation in SMT-LIB standard format (Version 2.6).
         * If printed to a .smt2 file, this should be accepted as input by
-        * most solvers.
+        * most solvers, soft rules and optional assignments need an OMT solver.
+        * Hard rules and fixed slots are named r[handle] and fa[assignmentID]s[slotID].
         * @param ostr destination of the output
+        * @param threads number of threads generating declarations, assignments and rules,
+        * the output is the same for any number
+        * @throws std::invalid_argument if an ID contains | or \\, which SMT-LIB symbols cannot hold
         */
-        void print(std::ostream &ostr) const;
+        void print(std::ostream &ostr, const SMT_OBJECTIVE &objective = SMT_OBJECTIVE::ASSERT_SOFT,
+                   const size_t &threads = 1) const;
+
+        /**
+         * Writes the SMT-LIB formulation to a file without going through iostreams.
+         * @param compress gzip the file, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the file cannot be opened or written
+         */
+        void print(const std::string &path, const bool &compress = false,
+                   const SMT_OBJECTIVE &objective = SMT_OBJECTIVE::ASSERT_SOFT, const size_t &threads = 1) const;
+
+        void print(SmtWriter &ostr, const SMT_OBJECTIVE &objective = SMT_OBJECTIVE::ASSERT_SOFT,
+                   const size_t &threads = 1) const;
+
+        /**
+         * Content hash of the components with their groups, tags and values, the groups and tags,
+         * the assignments with their slots and the rules with their conditions.
+         * Problems built the same way have the same fingerprint on every platform and in every run.
+         */
+        uint64_t getFingerprint() const;
+
+        /**
+         * Second hash of the same content as getFingerprint, computed independently of it
+         */
+        uint64_t getFingerprintCheck() const;
 
         //Component<ID> &newComponent(const ID &id, const ComponentType<ID> &type);
 
@@ -91,9 +133,10 @@ namespace omtsched {
         
         
         /**
-         *
-         *
-         *
+         * Adds a hard or a soft rule
+         * @param c the rule's condition
+         * @param hard if false, the rule may be violated at the cost of its weight
+         * @param weight penalty for violating a soft rule
          */
         void addRule(std::shared_ptr<Condition<ID>> c, const bool &hard, const int &weight);
 
@@ -106,6 +149,13 @@ namespace omtsched {
 
     private:
 
+        // prints items [0, count) in order, on several threads into separate buffers if threads > 1
+        template<typename PrintItem>
+        static void printItems(SmtWriter &ostr, const size_t &count, const size_t &threads, const PrintItem &printItem);
+
+        // the hashes of getFingerprint and getFingerprintCheck
+        Fingerprint fingerprint() const;
+
         std::set<ID> tags;
 
         std::set<ID> groups;
@@ -132,8 +182,8 @@ namespace omtsched {
     }
 
     template<typename ID>
-    void Problem<ID>::addRule(std::shared_ptr<Condition<ID>> c, const bool &optional, const int &weight) {
-        rules.emplace_back(std::move(c), optional, weight);
+    void Problem<ID>::addRule(std::shared_ptr<Condition<ID>> c, const bool &hard, const int &weight) {
+        rules.emplace_back(std::move(c), !hard, weight);
     }
 /*
     //itc21.addRule( MaxAssignment( max, InGroup(gameType, mode+team), ComponentIn(slotType, slots)), hard);
@@ -224,36 +274,188 @@ namespace omtsched {
     }
 
     template<typename ID>
-    void Problem<ID>::print(std::ostream &ostr) const {
+    void Problem<ID>::print(std::ostream &ostr, const SMT_OBJECTIVE &objective, const size_t &threads) const {
+
+        SmtWriter writer {ostr};
+        print(writer, objective, threads);
+    }
+
+    template<typename ID>
+    void Problem<ID>::print(const std::string &path, const bool &compress, const SMT_OBJECTIVE &objective,
+                            const size_t &threads) const {
+
+        SmtWriter writer {path, compress};
+        print(writer, objective, threads);
+        writer.flush();
+        if(!writer.good())
+            throw std::runtime_error("could not write " + path);
+    }
+
+    template<typename ID>
+    uint64_t Problem<ID>::getFingerprint() const {
+        return fingerprint().getValue();
+    }
+
+    template<typename ID>
+    uint64_t Problem<ID>::getFingerprintCheck() const {
+        return fingerprint().getCheck();
+    }
+
+    template<typename ID>
+    Fingerprint Problem<ID>::fingerprint() const {
+
+        Fingerprint f;
+
+        f << components.size();
+        for(const auto &[typeID, components] : components) {
+
+            f << typeID << components.size();
+            for(const auto &component : components) {
+
+                f << component->getID() << component->getGroups().size();
+                for(const ID &group : component->getGroups())
+                    f << group;
+
+                f << component->getTags().size();
+                for(const auto &[tag, value] : component->getTags())
+                    f << tag << value;
+
+                const auto ordered = std::dynamic_pointer_cast<OrderedComponent<ID>>(component);
+                f << (ordered != nullptr);
+                if(ordered)
+                    f << ordered->getValue();
+            }
+        }
 
+        f << groups.size();
+        for(const ID &group : groups)
+            f << group;
+
+        f << tags.size();
+        for(const ID &tag : tags)
+            f << tag;
+
+        f << assignments.size();
+        for(const auto &[asgnID, asgn] : assignments) {
+
+            f << asgnID << asgn.isOptional() << asgn.getWeight() << asgn.getComponentSlots().size();
+            for(const auto &[slotID, slot] : asgn.getComponentSlots()) {
+                f << slotID << slot.type << slot.optional << slot.fixed;
+                if(slot.fixed)
+                    f << slot.component;
+            }
+        }
+
+        f << rules.size();
+        for(const Rule<ID> &rule : rules) {
+            f << rule.isOptional() << rule.getWeight();
+            rule.getTopCondition()->fingerprint(f);
+        }
+
+        return f;
+    }
+
+    template<typename ID>
+    template<typename PrintItem>
+    void Problem<ID>::printItems(SmtWriter &ostr, const size_t &count, const size_t &threads,
+                                 const PrintItem &printItem) {
+
+        if(threads <= 1 || count < 2) {
+            for(size_t i = 0; i < count; i++)
+                printItem(ostr, i);
+            return;
+        }
+
+        // more chunks than threads, so a few expensive items do not leave the other threads idle
+        const size_t chunks = std::min(count, threads * 4);
+        std::vector<SmtWriter> parts(chunks);
+        std::atomic<size_t> next {0};
+
+        // the first item that cannot be printed stops all threads and is rethrown after the join
+        std::exception_ptr error;
+        std::mutex failure;
+
+        const auto work = [&]() {
+            try {
+                for(size_t chunk = next++; chunk < chunks; chunk = next++)
+                    for(size_t i = chunk * count / chunks; i < (chunk + 1) * count / chunks; i++)
+                        printItem(parts.at(chunk), i);
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> lock {failure};
+                if(!error)
+                    error = std::current_exception();
+                next = chunks;
+            }
+        };
+
+        std::vector<std::thread> running;
+        for(size_t t = 1; t < std::min(threads, chunks); t++)
+            running.emplace_back(work);
+        work();
+        for(std::thread &thread : running)
+            thread.join();
+
+        if(error)
+            std::rethrow_exception(error);
+
+        // in order, shared terms are numbered as in a serial write
+        for(const SmtWriter &part : parts)
+            ostr.insert(part);
+    }
+
+    template<typename ID>
+    void Problem<ID>::print(SmtWriter &ostr, const SMT_OBJECTIVE &objective, const size_t &threads) const {
+
+        // the penalties: weighted soft rules and optional assignments
+        std::vector<std::pair<size_t, int>> softRules;
+        for(size_t handle = 0; handle < rules.size(); handle++)
+            if(rules.at(handle).isOptional() && rules.at(handle).getWeight() != 0)
+                softRules.emplace_back(handle, rules.at(handle).getWeight());
+
+        std::vector<std::pair<ID, int>> unfilled;
+        for(const auto &[asgnID, asgn] : assignments)
+            if(asgn.isOptional() && asgn.getWeight() != 0)
+                unfilled.emplace_back(asgnID, asgn.getWeight());
+
+        const bool minimize = objective == SMT_OBJECTIVE::MINIMIZE && !(softRules.empty() && unfilled.empty());
 
         // Pase 0: setup
-        ostr << "(set-logic QF_EQ)" << std::endl;
+        // uninterpreted sorts with distinct constants, only the summed objective needs arithmetic
+        ostr << (minimize ? "(set-logic QF_UFLIA)\n" : "(set-logic QF_UF)\n");
 
-        ostr << std::endl;
-        ostr << "; Component Types" << std::endl;
-        ostr << "; A component types name is t[typeID]" << std::endl;
-        ostr << std::endl;
+        ostr << "\n";
+        ostr << "; Component Types\n";
+        ostr << "; A component types name is t[typeID]\n";
+        ostr << "\n";
 
         // Create a sort for each types
         // Format:
-        for(const auto &[typeID, components] : components)
-            ostr << "(declare-sort " << "t" << typeID << " 0)" << std::endl;
+        for(const auto &[typeID, components] : components) {
+            ostr << "(declare-sort ";
+            ostr.symbol("t", typeID) << " 0)\n";
+        }
 
         //for(const auto &[typeID, components] : orderedComponents)
         //    ostr << "(declare-sort " << "t" << typeID << " 0)" << std::endl;
 
         // Phase 1: declare constants and variables
 
-        ostr << std::endl;
-        ostr << "; Components" << std::endl;
-        ostr << "; a components name is c[componentID]" << std::endl;
-        ostr << std::endl;
+        ostr << "\n";
+        ostr << "; Components\n";
+        ostr << "; a components name is c[componentID]\n";
+        ostr << "\n";
 
-        for(const auto &[typeID, components] : components){
+        std::vector<std::pair<const ID *, const Component<ID> *>> declared;
+        for(const auto &[typeID, components] : components)
             for(const auto &component : components)
-                ostr << "(declare-fun c" << component->getID() << " () t" << typeID << ")" << std::endl;
-        }
+                declared.emplace_back(&typeID, component.get());
+
+        printItems(ostr, declared.size(), threads, [&](SmtWriter &out, const size_t &i) {
+            out << "(declare-fun ";
+            out.symbol("c", declared.at(i).second->getID()) << " () ";
+            out.symbol("t", *declared.at(i).first) << ")\n";
+        });
         /*
         for(const auto &[typeID, components] : orderedComponents){
             for(const Component<ID> &component : components)
@@ -265,18 +467,23 @@ namespace omtsched {
 
         // Phase 2: declare constraints
 
-        ostr << std::endl;
-        ostr << "; Distinctness Constraints" << std::endl;
-        ostr << "; components are assumed to be unique" << std::endl;
-        ostr << std::endl;
+        ostr << "\n";
+        ostr << "; Distinctness Constraints\n";
+        ostr << "; components are assumed to be unique\n";
+        ostr << "\n";
 
         for(const auto &[typeID, components] : components){
 
-            ostr << "(distinct";
-            for(const std::shared_ptr<Component<ID>> &component : components)
-                ostr << " c" << component->getID();
+            if(components.size() < 2)
+                continue;
 
-            ostr << ")" << std::endl;
+            ostr << "(assert (distinct";
+            for(const std::shared_ptr<Component<ID>> &component : components) {
+                ostr << ' ';
+                ostr.symbol("c", component->getID());
+            }
+
+            ostr << "))\n";
         }
         /*
         for(const auto &[typeID, components] : orderedComponents){
@@ -288,29 +495,101 @@ namespace omtsched {
             ostr << ")" << std::endl;
         }*/
 
-        ostr << std::endl;
-        ostr << "; Assignments" << std::endl;
-        ostr << "; a slot variables name is a[assignmentID]s[slotID]" << std::endl;
-        ostr << std::endl;
+        ostr << "\n";
+        ostr << "; Assignments\n";
+        ostr << "; a slot variables name is a[assignmentID]s[slotID]\n";
+        ostr << "; an optional assignment is filled if act[assignmentID] holds\n";
+        ostr << "\n";
 
-        // std::map<ID, Assignment<ID>> assignments;
-        for(const auto &[asgnID, asgn] : assignments) {
-            for(const auto &[slotID, slot] : asgn.getComponentSlots()){
+        std::vector<const Assignment<ID> *> ordered;
+        for(const auto &[asgnID, asgn] : assignments)
+            ordered.push_back(&asgn);
 
-                ostr << "(declare-fun a" << asgnID << "s" << slotID << " () t" << slot.type << ")" << std::endl;
+        printItems(ostr, ordered.size(), threads, [&](SmtWriter &out, const size_t &i) {
 
-                if(slot.fixed)
-                    ostr << "(assert (= a" << asgnID << "s" << slotID <<  " c" << slot.component << "))" << std::endl;
+            const Assignment<ID> &asgn = *ordered.at(i);
+            const ID &asgnID = asgn.getID();
+
+            if(asgn.isOptional()) {
+                out << "(declare-fun ";
+                printActive(out, asgn) << " () Bool)\n";
             }
-        }
+
+            for(const auto &[slotID, slot] : asgn.getComponentSlots()){
+
+                out << "(declare-fun ";
+                printSlot(out, asgnID, slotID) << " () ";
+                out.symbol("t", slot.type) << ")\n";
+
+                // the sort is open, every slot takes one of the components of its type
+                out << "(assert ";
+                if(asgn.isOptional() && !slot.fixed) {
+                    out << "(=> ";
+                    printActive(out, asgn) << ' ';
+                }
+                out << "(or false";
+                for(const auto &component : getComponents(slot.type)) {
+                    out << " (= ";
+                    printSlot(out, asgnID, slotID) << ' ';
+                    out.symbol("c", component->getID()) << ')';
+                }
+                out << (asgn.isOptional() && !slot.fixed ? ")))\n" : "))\n");
+
+                if(slot.fixed) {
+                    out << "(assert (! (= ";
+                    printSlot(out, asgnID, slotID) << ' ';
+                    out.symbol("c", slot.component) << ") :named ";
+                    out.symbol("fa", asgnID, "s", slotID) << "))\n";
+                }
+            }
+        });
+
+        ostr << "\n";
+        ostr << "; Rules\n";
+        ostr << "; hard rules are named r[handle], soft rules are defined as r[handle]\n";
+        ostr << "\n";
 
         // rules specify their own
-        for(const auto &rule : rules)
-            rule.print(ostr);
+        printItems(ostr, rules.size(), threads, [&](SmtWriter &out, const size_t &handle) {
+            rules.at(handle).print(out, *this, handle);
+        });
 
-        // TODO: optimization
+        // Phase 3: optimization
+        if(!softRules.empty() || !unfilled.empty()) {
+
+            ostr << "\n";
+            ostr << "; Objective\n";
+            ostr << "; violated soft rules and unfilled optional assignments cost their weight\n";
+            ostr << "\n";
+        }
+
+        if(minimize) {
+
+            ostr << "(minimize (+ 0";
+            for(const auto &[handle, weight] : softRules) {
+                ostr << " (ite ";
+                ostr.symbol("r", handle) << " 0 " << weight << ')';
+            }
+            for(const auto &[asgnID, weight] : unfilled) {
+                ostr << " (ite ";
+                printActive(ostr, assignments.at(asgnID)) << " 0 " << weight << ')';
+            }
+            ostr << "))\n";
+        }
+        else {
+
+            for(const auto &[handle, weight] : softRules) {
+                ostr << "(assert-soft ";
+                ostr.symbol("r", handle) << " :weight " << weight << " :id penalty)\n";
+            }
+            for(const auto &[asgnID, weight] : unfilled) {
+                ostr << "(assert-soft ";
+                printActive(ostr, assignments.at(asgnID)) << " :weight " << weight << " :id penalty)\n";
+            }
+        }
 
-        ostr << "(check-sat)" << std::endl;
+        ostr << "\n";
+        ostr << "(check-sat)\n";
     }
 
 }
@@ -33,16 +33,27 @@ namespace omtsched {
 
         bool isRestricted() const;
 
-        void print(std::ostream &) const;
+        /**
+         * @return true for soft rules, which may be violated at the cost of their weight
+         */
+        bool isOptional() const;
 
-        void declareVariables(std::ostream &) const;
+        int getWeight() const;
+
+        /**
+         * Writes the rule as a named assertion, soft rules as a definition r[handle]
+         * @param handle position of the rule in the problem
+         */
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const size_t &handle) const;
+
+        void declareVariables(SmtWriter &) const;
 
     private:
         std::shared_ptr<Condition<ID>> toplevel;
-        bool restrictedSet;
+        bool restrictedSet = false;
         std::vector<std::vector<Assignment<ID>*>> applicableSets;
-        bool optional;
-        int weight;
+        bool optional = false;
+        int weight = 0;
     };
 
     template<typename ID>
@@ -75,6 +86,16 @@ namespace omtsched {
         return restrictedSet;
     }
 
+    template<typename ID>
+    bool Rule<ID>::isOptional() const {
+        return optional;
+    }
+
+    template<typename ID>
+    int Rule<ID>::getWeight() const {
+        return weight;
+    }
+
     template<typename ID>
     const std::vector<std::vector<Assignment<ID> *>> &Rule<ID>::getApplicableSets() {
 
@@ -106,24 +127,33 @@ namespace omtsched {
     }*/
 
     template<typename ID>
-    void Rule<ID>::print(std::ostream &ostr) const {
-
-        if(optional){ // TODO: optionality
-            }
+    void Rule<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const size_t &handle) const {
 
         // TODO: restricted sets
 
-        ostr << "(assert ";
-
-        // generate condition for each combination of assignments
-        for(const std::vector<Assignment<ID>*> &asgns : applicableSets)
-            toplevel->print(ostr, asgns);
-
-        ostr << ")" << std::endl;
+        // repeated subterms are defined ahead of the rule
+        ostr.beginCommand();
+
+        // soft rules are only defined, Problem::print states what violating them costs
+        if(optional) {
+            ostr << "(define-fun ";
+            ostr.symbol("r", handle) << " () Bool ";
+            toplevel->print(ostr, problem);
+            ostr << ")\n";
+        }
+        else {
+            // named like the rule's guard in the Z3 translator, so unsat cores refer to the same handles
+            ostr << "(assert (! ";
+            toplevel->print(ostr, problem);
+            ostr << " :named ";
+            ostr.symbol("r", handle) << "))\n";
+        }
+
+        ostr.endCommand();
     }
 
     template<typename ID>
-    void Rule<ID>::declareVariables(std::ostream &ostr) const {
+    void Rule<ID>::declareVariables(SmtWriter &ostr) const {
         for(const std::vector<Assignment<ID>*> &asgns : applicableSets)
             toplevel->declareVariables(ostr, asgns);
     }
@@ -0,0 +1,518 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_SMTWRITER_H
+#define OMTSCHED_SMTWRITER_H
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef OMTSCHED_ZLIB
+#include <zlib.h>
+#endif
+
+namespace omtsched {
+
+    /*
+     * Buffered emitter for SMT-LIB output.
+     * Text is collected in one reusable buffer that is handed to the destination only when full,
+     * integers are formatted with std::to_chars and nothing is flushed line by line.
+     * Writes to a std::ostream, to a file or, if built with OMTSCHED_ZLIB, to a gzip compressed file.
+     * A default constructed writer keeps its text in memory until it is inserted into another one,
+     * so parts of the output can be generated independently, e.g. on several threads.
+     */
+    class SmtWriter {
+
+    public:
+        /**
+         * @param ostr destination, only written to when the buffer is full and on flush
+         * @param capacity size of the buffer in bytes
+         */
+        explicit SmtWriter(std::ostream &ostr, const size_t &capacity = 1 << 20);
+
+        /**
+         * Writes to a file, bypassing iostreams. Check good after the last flush, errors of the final
+         * write in the destructor cannot be reported.
+         * @param compress gzip the output, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the file cannot be opened or compress is set without OMTSCHED_ZLIB
+         */
+        SmtWriter(const std::string &path, const bool &compress, const size_t &capacity = 1 << 20);
+
+        /**
+         * Collects the text in memory, shared terms are only named once it is inserted
+         */
+        SmtWriter();
+
+        SmtWriter(const SmtWriter &) = delete;
+        SmtWriter &operator=(const SmtWriter &) = delete;
+
+        ~SmtWriter();
+
+        /**
+         * Text is written as is, integers in decimal, everything else through its operator<<
+         */
+        template<typename T>
+        SmtWriter &operator<<(const T &value);
+
+        SmtWriter &operator<<(const char &c);
+
+        SmtWriter &operator<<(const bool &value);
+
+        /**
+         * Writes one symbol made of all parts, e.g. symbol("a", assignment, "s", slot).
+         * Symbols with characters outside the simple SMT-LIB symbols are quoted as |...|
+         * @throws std::invalid_argument if a part contains | or \\, which no symbol can hold
+         */
+        template<typename... Parts>
+        SmtWriter &symbol(const Parts &... parts);
+
+        /**
+         * Collects a top level command, e.g. an assertion, until endCommand,
+         * so that the definitions of the shared terms inside it can be written ahead of it
+         */
+        void beginCommand();
+
+        void endCommand();
+
+        /**
+         * Writes the term printed by print(*this) only once: longer terms are defined as
+         * (define-fun d[n] () Bool term) ahead of the current command and referred to by name,
+         * every repetition within the same output reuses the definition.
+         * Outside of a command the term is written as is.
+         */
+        template<typename Print>
+        SmtWriter &shared(const Print &print);
+
+        /**
+         * @return number of shared terms that were defined
+         */
+        size_t getDefinitionCount() const;
+
+        /**
+         * Appends the text collected by a default constructed writer.
+         * Shared terms are named and defined as if the part had been written to this writer directly,
+         * so inserting the parts in order gives the same output as writing them one after the other.
+         */
+        void insert(const SmtWriter &part);
+
+        /**
+         * Hands the buffer to the destination and flushes it
+         */
+        void flush();
+
+        /**
+         * @return bytes written so far, before compression
+         */
+        size_t getBytesWritten() const;
+
+        /**
+         * @return false if the destination rejected a write or a flush
+         */
+        bool good() const;
+
+    private:
+        void write(const char *data, const size_t &size);
+        void drain();
+        void emit(const char *data, const size_t &size);
+
+        template<typename T>
+        static void append(std::string &text, const T &value);
+
+        static bool isSimpleSymbolChar(const char &c);
+
+        // appends the name of the term, or the term itself if it is short, and defines new names
+        void share(std::string &&term, std::string &out);
+
+        // replaces the placeholders of the part's shared terms in text
+        void resolve(const SmtWriter &part, const std::string_view &text, std::string &out,
+                     std::vector<std::string> &names);
+
+        std::vector<char> buffer;
+        size_t used = 0;
+        size_t written = 0;
+        bool failed = false;
+
+        // exactly one destination is set, none if the text is kept in memory
+        std::ostream *ostr = nullptr;
+        FILE *file = nullptr;
+#ifdef OMTSCHED_ZLIB
+        gzFile compressed = nullptr;
+#endif
+
+        // reused to assemble symbols
+        std::string scratch;
+
+        // while a command or shared term is being collected, text goes to the innermost capture
+        std::vector<std::string> captures;
+        size_t commands = 0;
+        // definitions waiting for the current command to end
+        std::string definitions;
+        std::unordered_map<std::string, size_t> sharedTerms;
+
+        // text kept in memory: shared terms are written as \x01[index]\x02 into deferredTerms,
+        // named only on insert since the numbering depends on everything written before
+        bool detached = false;
+        std::string text;
+        std::vector<const std::string *> deferredTerms;
+        std::vector<std::pair<size_t, size_t>> commandRanges;
+
+        // shorter terms are cheaper to repeat than to name
+        static constexpr size_t minimumShared = 24;
+    };
+
+    inline SmtWriter::SmtWriter(std::ostream &ostr, const size_t &capacity) : buffer(capacity), ostr{&ostr} {
+
+        assert(capacity > 0 && "the buffer needs room for at least one byte");
+    }
+
+    inline SmtWriter::SmtWriter(const std::string &path, const bool &compress, const size_t &capacity) : buffer(capacity) {
+
+        assert(capacity > 0 && "the buffer needs room for at least one byte");
+
+        if(compress) {
+#ifdef OMTSCHED_ZLIB
+            compressed = gzopen(path.c_str(), "wb");
+            if(!compressed)
+                throw std::runtime_error("could not open the output file " + path);
+            // zlib gets whole buffers, its own one only needs to match them
+            gzbuffer(compressed, (unsigned) std::min(capacity, size_t{1} << 24));
+#else
+            throw std::runtime_error("compressed output needs OMTSCHED_ZLIB");
+#endif
+            return;
+        }
+
+        file = std::fopen(path.c_str(), "wb");
+        if(!file)
+            throw std::runtime_error("could not open the output file " + path);
+        // the buffer above already batches the writes
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+
+    inline SmtWriter::SmtWriter() : detached{true} {}
+
+    inline SmtWriter::~SmtWriter() {
+
+        drain();
+
+        if(ostr)
+            ostr->flush();
+        if(file)
+            std::fclose(file);
+#ifdef OMTSCHED_ZLIB
+        if(compressed)
+            gzclose(compressed);
+#endif
+    }
+
+    template<typename T>
+    SmtWriter &SmtWriter::operator<<(const T &value) {
+
+        if constexpr (std::is_integral_v<T>) {
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            write(digits, result.ptr - digits);
+        }
+        else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            const std::string_view text = value;
+            write(text.data(), text.size());
+        }
+        else {
+            std::ostringstream text;
+            text << value;
+            const std::string &str = text.str();
+            write(str.data(), str.size());
+        }
+
+        return *this;
+    }
+
+    inline SmtWriter &SmtWriter::operator<<(const char &c) {
+
+        if(!captures.empty()) {
+            captures.back().push_back(c);
+            return *this;
+        }
+
+        if(detached) {
+            text.push_back(c);
+            return *this;
+        }
+
+        if(used == buffer.size())
+            drain();
+        buffer[used++] = c;
+
+        return *this;
+    }
+
+    inline SmtWriter &SmtWriter::operator<<(const bool &value) {
+        return *this << (value ? "true" : "false");
+    }
+
+    template<typename... Parts>
+    SmtWriter &SmtWriter::symbol(const Parts &... parts) {
+
+        scratch.clear();
+        (append(scratch, parts), ...);
+
+        bool simple = !scratch.empty() && (scratch.front() < '0' || scratch.front() > '9');
+        for(const char &c : scratch)
+            simple = simple && isSimpleSymbolChar(c);
+
+        if(simple)
+            return *this << scratch;
+
+        // quoted symbols have no escapes
+        if(scratch.find_first_of("|\\") != std::string::npos)
+            throw std::invalid_argument("the ID in " + scratch + " cannot be written as an SMT-LIB symbol, it contains | or \\");
+
+        return *this << '|' << scratch << '|';
+    }
+
+    inline void SmtWriter::beginCommand() {
+
+        assert(captures.empty() && "commands cannot be nested");
+        captures.emplace_back();
+        commands = captures.size();
+    }
+
+    inline void SmtWriter::endCommand() {
+
+        assert(captures.size() == commands && "shared term still open at the end of the command");
+
+        std::string command = std::move(captures.back());
+        captures.pop_back();
+        commands = 0;
+
+        if(detached) {
+            commandRanges.emplace_back(text.size(), text.size() + command.size());
+            text.append(command);
+            return;
+        }
+
+        write(definitions.data(), definitions.size());
+        definitions.clear();
+        write(command.data(), command.size());
+    }
+
+    template<typename Print>
+    SmtWriter &SmtWriter::shared(const Print &print) {
+
+        if(commands == 0) {
+            print(*this);
+            return *this;
+        }
+
+        captures.emplace_back();
+        print(*this);
+        std::string term = std::move(captures.back());
+        captures.pop_back();
+
+        if(detached) {
+            // the length and name are only known once the nested placeholders are resolved
+            auto [it, inserted] = sharedTerms.emplace(std::move(term), deferredTerms.size());
+            if(inserted)
+                deferredTerms.push_back(&it->first);
+            return *this << '\x01' << it->second << '\x02';
+        }
+
+        std::string name;
+        share(std::move(term), name);
+        return *this << name;
+    }
+
+    inline void SmtWriter::insert(const SmtWriter &part) {
+
+        assert(part.detached && !detached && "only a writer kept in memory can be inserted into an output");
+        assert(captures.empty() && part.captures.empty() && "commands have to be complete");
+
+        // the name or text of each of the part's shared terms, once resolved
+        std::vector<std::string> names(part.deferredTerms.size());
+
+        size_t offset = 0;
+        for(const auto &[begin, end] : part.commandRanges) {
+
+            write(part.text.data() + offset, begin - offset);
+
+            std::string command;
+            resolve(part, std::string_view{part.text}.substr(begin, end - begin), command, names);
+
+            write(definitions.data(), definitions.size());
+            definitions.clear();
+            write(command.data(), command.size());
+
+            offset = end;
+        }
+
+        write(part.text.data() + offset, part.text.size() - offset);
+    }
+
+    inline void SmtWriter::share(std::string &&term, std::string &out) {
+
+        if(term.size() < minimumShared) {
+            out.append(term);
+            return;
+        }
+
+        auto [it, inserted] = sharedTerms.emplace(std::move(term), sharedTerms.size());
+
+        if(inserted) {
+            // nested terms have already added their definitions, so they come first
+            definitions.append("(define-fun d");
+            append(definitions, it->second);
+            definitions.append(" () Bool ").append(it->first).append(")\n");
+        }
+
+        out.push_back('d');
+        append(out, it->second);
+    }
+
+    inline void SmtWriter::resolve(const SmtWriter &part, const std::string_view &text, std::string &out,
+                                   std::vector<std::string> &names) {
+
+        size_t offset = 0;
+        for(size_t marker = text.find('\x01'); marker != std::string_view::npos; marker = text.find('\x01', offset)) {
+
+            out.append(text.substr(offset, marker - offset));
+
+            const size_t close = text.find('\x02', marker);
+            size_t index = 0;
+            std::from_chars(text.data() + marker + 1, text.data() + close, index);
+
+            // the first occurrence decides the name, in the same order as a direct write would
+            if(names.at(index).empty()) {
+                std::string term;
+                resolve(part, *part.deferredTerms.at(index), term, names);
+                share(std::move(term), names.at(index));
+            }
+            out.append(names.at(index));
+
+            offset = close + 1;
+        }
+
+        out.append(text.substr(offset));
+    }
+
+    inline size_t SmtWriter::getDefinitionCount() const {
+        return sharedTerms.size();
+    }
+
+    inline void SmtWriter::flush() {
+
+        drain();
+
+        if(ostr && !ostr->flush())
+            failed = true;
+        if(file && std::fflush(file) != 0)
+            failed = true;
+#ifdef OMTSCHED_ZLIB
+        if(compressed && gzflush(compressed, Z_SYNC_FLUSH) != Z_OK)
+            failed = true;
+#endif
+    }
+
+    inline size_t SmtWriter::getBytesWritten() const {
+        return written + used + text.size();
+    }
+
+    inline bool SmtWriter::good() const {
+        return !failed;
+    }
+
+    inline void SmtWriter::write(const char *data, const size_t &size) {
+
+        if(!captures.empty()) {
+            captures.back().append(data, size);
+            return;
+        }
+
+        if(detached) {
+            text.append(data, size);
+            return;
+        }
+
+        // large pieces bypass the buffer
+        if(size >= buffer.size()) {
+            drain();
+            emit(data, size);
+            return;
+        }
+
+        size_t offset = 0;
+        while(offset < size) {
+
+            if(used == buffer.size())
+                drain();
+
+            const size_t chunk = std::min(size - offset, buffer.size() - used);
+            std::copy(data + offset, data + offset + chunk, buffer.data() + used);
+            used += chunk;
+            offset += chunk;
+        }
+    }
+
+    inline void SmtWriter::drain() {
+
+        if(used == 0)
+            return;
+
+        emit(buffer.data(), used);
+        used = 0;
+    }
+
+    inline void SmtWriter::emit(const char *data, const size_t &size) {
+
+        if(ostr && !ostr->write(data, (std::streamsize) size))
+            failed = true;
+        if(file && std::fwrite(data, 1, size, file) != size)
+            failed = true;
+#ifdef OMTSCHED_ZLIB
+        if(compressed && gzwrite(compressed, data, (unsigned) size) != (int) size)
+            failed = true;
+#endif
+
+        written += size;
+    }
+
+    template<typename T>
+    void SmtWriter::append(std::string &text, const T &value) {
+
+        if constexpr (std::is_same_v<T, char>)
+            text.push_back(value);
+        else if constexpr (std::is_integral_v<T>) {
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            text.append(digits, result.ptr - digits);
+        }
+        else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+            text.append(std::string_view{value});
+        else {
+            std::ostringstream str;
+            str << value;
+            text.append(str.str());
+        }
+    }
+
+    inline bool SmtWriter::isSimpleSymbolChar(const char &c) {
+
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+            return true;
+
+        return std::string_view{"~!@$%^&*_-+=<>.?/"}.find(c) != std::string_view::npos;
+    }
+
+}
+
+#endif //OMTSCHED_SMTWRITER_H
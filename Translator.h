@@ -7,6 +7,7 @@
 
 #include "Problem.h"
 #include "Model.h"
+#include "Explanation.h"
 #include <string>
 
 namespace omtsched {
@@ -40,8 +41,8 @@ namespace omtsched {
 
     protected:
         const Problem<ID> &problem;
-        bool generateAllSolution;
-        bool generateExplanations;
+        bool generateAllSolution = false;
+        bool generateExplanations = false;
 
     };
 
@@ -14,9 +14,10 @@ namespace omtsched {
     class ComponentIs : public Condition<ID> {
 
     public:
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &) const;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &) const;
         const CONDITION_TYPE getType() const override;
+        void fingerprint(Fingerprint &f) const override;
 
         ComponentIs(ID componentSlot, ID component) : componentSlot{componentSlot},
         component{component} {};
@@ -35,6 +36,13 @@ namespace omtsched {
         return CONDITION_TYPE::COMPONENT_IS;
     }
 
+    template<typename ID>
+    void ComponentIs<ID>::fingerprint(Fingerprint &f) const {
+
+        Condition<ID>::fingerprint(f);
+        f << componentSlot << component;
+    }
+
     // TODO: it should be possible to simply pass a newly constructed condition to addRule
     //template<typename ID, typename ConditionType>
     //std::shared_ptr<Condition<ID>> makeCondition(std:: arguments){
@@ -42,21 +50,19 @@ namespace omtsched {
     //}
 
     template<typename ID>
-    void ComponentIs<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
-
-        // (and (= a1s1 c1) ())
-        ostr << "(and ";
-
-        for(const Assignment<ID> *asgn : asgns) {
-
-            ostr << "(= "
-                 << "a" << asgn->getID() << "s" << componentSlot << " "
-                 << "c" << component
-                 << ")";
-
-        }
-
-        ostr << ")" << std::endl;
+    void ComponentIs<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
+
+        // (= a1s1 c1)
+        const auto instance = [&](const Assignment<ID> &a) {
+            ostr << "(= ";
+            printSlot(ostr, a.getID(), componentSlot) << ' ';
+            ostr.symbol("c", component) << ')';
+        };
+
+        if(asgn)
+            instance(*asgn);
+        else
+            printForAll(ostr, problem, componentSlot, instance);
     }
 
 
@@ -64,36 +70,59 @@ namespace omtsched {
     class InGroup : public Condition<ID> {
 
     public:
-        InGroup(const ID &componentType, ID groupID) : slot{slot}, group{groupID} {}
+        InGroup(const ID &componentSlot, ID groupID) : slot{componentSlot}, group{groupID} {}
         const ID slot;
         const ID group;
 
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &) const;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &) const;
         const CONDITION_TYPE getType() const override;
+        void fingerprint(Fingerprint &f) const override;
 
     };
 
+    template<typename ID>
+    std::shared_ptr<Condition<ID>> inGroup(const ID &slot, const ID &group) {
+        return std::make_shared<InGroup<ID>>(slot, group);
+    }
+
 template<typename ID>
 const CONDITION_TYPE InGroup<ID>::getType() const {
     return CONDITION_TYPE::IN_GROUP;
 }
 
     template<typename ID>
-    void InGroup<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
-
-        ostr << "(and";
-        for(const Assignment<ID>* asgn : asgns) {
+    void InGroup<ID>::fingerprint(Fingerprint &f) const {
 
-            const ID &slotID = asgn->getComponentSlots().at(slot);
-            ostr << "(or ";
-        }
+        Condition<ID>::fingerprint(f);
+        f << slot << group;
+    }
 
-        ostr << ")" << std::endl;
+    template<typename ID>
+    void InGroup<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
+
+        // one of the components of the slot's type in the group, the same for every rule testing the group
+        const auto instance = [&](const Assignment<ID> &a) {
+            ostr.shared([&](SmtWriter &term) {
+                term << "(or false";
+                for(const auto &component : problem.getComponents(a.getSlot(slot).type))
+                    if(component->inGroup(group)) {
+                        term << " (= ";
+                        printSlot(term, a.getID(), slot) << ' ';
+                        term.symbol("c", component->getID()) << ')';
+                    }
+                term << ')';
+            });
+        };
+
+        if(asgn)
+            instance(*asgn);
+        else
+            printForAll(ostr, problem, slot, instance);
     }
 
 template<typename ID>
-void InGroup<ID>::declareVariables(std::ostream &) const {return;}
+void InGroup<ID>::declareVariables(SmtWriter &) const {return;}
 
 template<typename ID>
     class SameComponent : public Condition<ID> {
@@ -102,9 +131,10 @@ template<typename ID>
         SameComponent(const ID &slotType) : slot{slotType} {}
         const ID slot;
 
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &) const;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &) const;
         const CONDITION_TYPE getType() const override;
+        void fingerprint(Fingerprint &f) const override;
 
     };
 
@@ -114,15 +144,17 @@ const CONDITION_TYPE SameComponent<ID>::getType() const {
 }
 
     template<typename ID>
-    void SameComponent<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
+    void SameComponent<ID>::fingerprint(Fingerprint &f) const {
 
-        ostr << " (=";
-        for(const Assignment<ID> *asgn : asgns) {
-            const ID &slotID = asgn->getComponentSlots().at(slot);
-            ostr << " a" << asgn->getID() << "s" << slotID;
-        }
-        ostr << ")";
+        Condition<ID>::fingerprint(f);
+        f << slot;
+    }
+
+    template<typename ID>
+    void SameComponent<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
+        // compares combinations of assignments, rules only instantiate single ones so far
+        ostr << "true";
     }
 
 
@@ -136,11 +168,11 @@ public:
     const ID slotType;
     const std::vector<ID> &components;
 
-    void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
 };
 
 template<typename ID>
-void ComponentIn<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
+void ComponentIn<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
 }
 */
@@ -149,9 +181,10 @@ void ComponentIn<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>
     class Distinct : public Condition<ID> {
 
     public:
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &) const;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &) const;
         const CONDITION_TYPE getType() const override;
+        void fingerprint(Fingerprint &f) const override;
 
         Distinct(ID componentSlot) : Condition<ID>(), componentSlot{componentSlot} {};
 
@@ -163,20 +196,55 @@ const CONDITION_TYPE Distinct<ID>::getType() const {
     return CONDITION_TYPE::DISTINCT;
 }
 
+    template<typename ID>
+    void Distinct<ID>::fingerprint(Fingerprint &f) const {
+
+        Condition<ID>::fingerprint(f);
+        f << componentSlot;
+    }
+
 template<typename ID>
     std::shared_ptr<Condition<ID>> distinct(const ID &slot) {
         return std::make_shared<Distinct<ID>>(slot);
     }
 
     template<typename ID>
-    void Distinct<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
+    void Distinct<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *) const {
+
+        // the slots of all assignments, independent of the instance
+        ostr << "(and true";
+
+        std::vector<ID> required;
+        for(const auto &[id, a] : problem.getAssignments())
+            if(!a.isOptional())
+                required.push_back(id);
+
+        if(required.size() > 1) {
+            ostr << " (distinct";
+            for(const ID &id : required) {
+                ostr << ' ';
+                printSlot(ostr, id, componentSlot);
+            }
+            ostr << ')';
+        }
+
+        // optional assignments only conflict with others while they are active
+        for(const auto &[id, a] : problem.getAssignments()) {
 
-        ostr << "(distinct";
+            if(!a.isOptional())
+                continue;
 
-        for(const Assignment<ID>* asgn : asgns)
-            ostr << " a" << asgn->getID() << "s" << componentSlot;
+            for(const auto &[other, b] : problem.getAssignments())
+                if(other != id && (!b.isOptional() || other > id)) {
+                    ostr << " (=> (and ";
+                    printActive(ostr, a) << ' ';
+                    printActive(ostr, b) << ") (not (= ";
+                    printSlot(ostr, id, componentSlot) << ' ';
+                    printSlot(ostr, other, componentSlot) << ")))";
+                }
+        }
 
-        ostr << ") ";
+        ostr << ')';
     }
 
 
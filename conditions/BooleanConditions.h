@@ -16,7 +16,7 @@ class Not : public Condition<ID> {
 public:
     Not(std::shared_ptr<Condition < ID>> subcondition) : Condition<ID>({std::move(subcondition)}) {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -26,11 +26,11 @@ public:
     }
 
 template<typename ID>
-void Not<ID>::print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgn) const {
+void Not<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
     ostr << "(not ";
-    this->subconditions.at(0)->print(ostr, asgn);
-    ostr << ") ";
+    this->subconditions.at(0)->print(ostr, problem, asgn);
+    ostr << ')';
 }
 
 template<typename ID>
@@ -44,7 +44,7 @@ class And : public Condition<ID> {
 public:
     And(std::vector<std::shared_ptr<Condition < ID>>> subconditions) : Condition<ID>(std::move(subconditions) ) {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -54,13 +54,15 @@ const CONDITION_TYPE And<ID>::getType() const {
 }
 
 template<typename ID>
-void And<ID>::print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgn) const {
+void And<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
-    ostr << "(and ";
-    for(const auto &subcondition : this->subconditions)
-        subcondition->print(ostr, asgn);
+    ostr << "(and true";
+    for(const auto &subcondition : this->subconditions) {
+        ostr << ' ';
+        subcondition->print(ostr, problem, asgn);
+    }
 
-    ostr << ") ";
+    ostr << ')';
 }
 
 template<typename ID>
@@ -74,7 +76,7 @@ class Or : public Condition<ID> {
 public:
     Or(std::vector<std::shared_ptr<Condition < ID>>> subconditions) : Condition<ID>(std::move(subconditions)) {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -84,13 +86,15 @@ const CONDITION_TYPE Or<ID>::getType() const {
 }
 
 template<typename ID>
-void Or<ID>::print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgn) const {
+void Or<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
-ostr << "(or ";
-for(const auto &subcondition : this->subconditions)
-    subcondition->print(ostr, asgn);
+ostr << "(or false";
+for(const auto &subcondition : this->subconditions) {
+    ostr << ' ';
+    subcondition->print(ostr, problem, asgn);
+}
 
-ostr << ") ";
+ostr << ')';
 }
 
 template<typename ID>
@@ -103,7 +107,7 @@ class Implies : public Condition<ID> {
 public:
     Implies(std::shared_ptr<Condition < ID>> antecedent, std::shared_ptr<Condition < ID>> consequent) : Condition<ID>({antecedent, consequent}) {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -113,12 +117,28 @@ const CONDITION_TYPE Implies<ID>::getType() const {
 }
 
 template<typename ID>
-void Implies<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgn) const {
+void Implies<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *) const {
+
+    // instantiated for every assignment, also below the top level (as in the Z3 translator)
+    ostr << "(and true";
+    for(const auto &[id, a] : problem.getAssignments()) {
 
-    ostr << "(=> ";
-    this->subconditions.at(0)->print(ostr, asgn);
-    this->subconditions.at(1)->print(ostr, asgn);
-    ostr << ") ";
+        ostr << ' ';
+        if(a.isOptional()) {
+            ostr << "(=> ";
+            printActive(ostr, a) << ' ';
+        }
+
+        ostr << "(=> ";
+        this->subconditions.at(0)->print(ostr, problem, &a);
+        ostr << ' ';
+        this->subconditions.at(1)->print(ostr, problem, &a);
+        ostr << ')';
+
+        if(a.isOptional())
+            ostr << ')';
+    }
+    ostr << ')';
 }
 
 template<typename ID>
@@ -131,7 +151,7 @@ class Xor : public Condition<ID> {
 public:
     Xor(std::shared_ptr<Condition < ID>> first, std::shared_ptr<Condition < ID>> second) : Condition<ID>({std::move(first), std::move(second)})  {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -141,12 +161,13 @@ const CONDITION_TYPE Xor<ID>::getType() const {
 }
 
 template<typename ID>
-void Xor<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgn) const {
+void Xor<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
-ostr << "(=> ";
-this->subconditions.at(0)->print(ostr, asgn);
-    this->subconditions.at(1)->print(ostr, asgn);
-ostr << ") ";
+ostr << "(xor ";
+this->subconditions.at(0)->print(ostr, problem, asgn);
+ostr << ' ';
+this->subconditions.at(1)->print(ostr, problem, asgn);
+ostr << ')';
 }
 
 template<typename ID>
@@ -159,7 +180,7 @@ class Iff : public Condition<ID> {
 public:
     Iff(std::shared_ptr<Condition < ID>> first, std::shared_ptr<Condition < ID>> second) : Condition<ID>({std::move(first), std::move(second) }) {}
 
-    void print(std::ostream &ostr, const std::vector<Assignment < ID> *> &asgns) const override;
+    void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
     const CONDITION_TYPE getType() const override;
 };
 
@@ -169,15 +190,13 @@ const CONDITION_TYPE Iff<ID>::getType() const {
 }
 
 template<typename ID>
-void Iff<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgn) const {
+void Iff<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const {
 
-ostr << "(and (=> ";
-this->subconditions.at(0)->print(ostr, asgn);
-    this->subconditions.at(1)->print(ostr, asgn);
-ostr << ") (=> ";
-    this->subconditions.at(1)->print(ostr, asgn);
-    this->subconditions.at(0)->print(ostr, asgn);
-ostr << ")) ";
+ostr << "(= ";
+this->subconditions.at(0)->print(ostr, problem, asgn);
+ostr << ' ';
+this->subconditions.at(1)->print(ostr, problem, asgn);
+ostr << ')';
 }
 
 template<typename ID>
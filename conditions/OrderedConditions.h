@@ -5,6 +5,7 @@
 #ifndef OMTSCHED_ORDEREDCONDITIONS_H
 #define OMTSCHED_ORDEREDCONDITIONS_H
 
+#include <algorithm>
 #include <vector>
 #include "../omtsched.h"
 
@@ -15,8 +16,8 @@ namespace omtsched {
     class Blocked : public NamedCondition<ID> {
 
     public:
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &, const std::vector<Assignment<ID>*> &) const override;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &, const std::vector<Assignment<ID>*> &) const override;
         virtual const CONDITION_TYPE getType() const override;
 
         Blocked(ID componentSlot, std::vector<std::shared_ptr<Condition<ID>>> subconditions = {}) :
@@ -35,31 +36,51 @@ const omtsched::CONDITION_TYPE omtsched::Blocked<ID>::getType() const {
 
 
 template<typename ID>
-    void Blocked<ID>::declareVariables(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgn) const {
+    void Blocked<ID>::declareVariables(SmtWriter &ostr, const std::vector<Assignment<ID>*> &asgn) const {
 
-        ostr << "(declare-fun block" << this->getNamedSlot() << " () (_ BitVec " << asgn.size() << "))" << std::endl;
+        ostr << "(declare-fun ";
+        ostr.symbol("block", this->getNamedSlot()) << " () (_ BitVec " << asgn.size() << "))" << '\n';
 
     }
 
 
     template<typename ID>
-    void Blocked<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
-
-
-        // recognize 0*1*0*
-        // shift left and xor, disregard rightmost: hamming weight of 0-2 legal (measure changes)
-        // same with right shift
-
-        // 00011100
-        // 00111000
-        // 00100100
-
-        // (bvxor s t) abbreviates (bvor (bvand s (bvnot t)) (bvand (bvnot s) t))
-        // (declare-fun a () (_ BitVec 32))
-
-        // TODO: for every bitvector constraint, declare variable at top of
-        // each bitvector constraint needs an id
-        //ostr << "(declare-fun bl" <<  << "(_ BitVec " << asgns.size() << "))"
+    void Blocked<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *) const {
+
+        // assignments ordered by the component of the named slot, ties by ID
+        std::vector<std::pair<ID, ID>> order;
+        for(const auto &[id, a] : problem.getAssignments())
+            order.emplace_back(a.getSlot(this->getNamedSlot()).component, id);
+        std::sort(order.begin(), order.end());
+
+        // an active assignment that fulfills one of the subconditions, used in many of the triples below
+        const auto holds = [&](const ID &id) {
+            const Assignment<ID> &a = problem.getAssignment(id);
+            ostr.shared([&](SmtWriter &term) {
+                term << "(and ";
+                printActive(term, a) << " (or false";
+                for(const auto &subcondition : this->subconditions) {
+                    term << ' ';
+                    subcondition->print(term, problem, &a);
+                }
+                term << "))";
+            });
+        };
+
+        // if two assignments fulfill the condition, so do all in between
+        ostr << "(and true";
+        for(size_t first = 0; first + 2 < order.size(); first++)
+            for(size_t last = first + 2; last < order.size(); last++)
+                for(size_t between = first + 1; between < last; between++) {
+                    ostr << " (=> (and ";
+                    holds(order.at(first).second);
+                    ostr << ' ';
+                    holds(order.at(last).second);
+                    ostr << ") ";
+                    holds(order.at(between).second);
+                    ostr << ')';
+                }
+        ostr << ')';
 
     }
 
@@ -68,8 +89,8 @@ template<typename ID>
     class Greater : public NamedCondition<ID> {
 
     public:
-        void print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const override;
-        void declareVariables(std::ostream &, const std::vector<Assignment<ID>*> &) const override;
+        void print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *asgn) const override;
+        void declareVariables(SmtWriter &, const std::vector<Assignment<ID>*> &) const override;
         virtual const CONDITION_TYPE getType() const override;
 
         Greater(ID componentSlot, std::vector<std::shared_ptr<Condition<ID>>> subconditions = {}) :
@@ -91,14 +112,38 @@ template<typename ID>
 
 
     template<typename ID>
-    void Greater<ID>::declareVariables(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgn) const {
+    void Greater<ID>::declareVariables(SmtWriter &, const std::vector<Assignment<ID>*> &) const {
         //TODO
     }
 
 
     template<typename ID>
-    void Greater<ID>::print(std::ostream &ostr, const std::vector<Assignment<ID>*> &asgns) const {
-        //TODO
+    void Greater<ID>::print(SmtWriter &ostr, const Problem<ID> &problem, const Assignment<ID> *) const {
+
+        const ID &namedSlot = this->getNamedSlot();
+
+        // an active assignment that fulfills one of the subconditions, each is part of many pairs
+        const auto holds = [&](const Assignment<ID> &a, const size_t &index) {
+            ostr.shared([&](SmtWriter &term) {
+                term << "(and ";
+                printActive(term, a) << ' ';
+                this->subconditions.at(index)->print(term, problem, &a);
+                term << ')';
+            });
+        };
+
+        // no active assignment fulfilling the first condition comes before one fulfilling the second
+        ostr << "(and true";
+        for(const auto &[id1, asgn1] : problem.getAssignments())
+            for(const auto &[id2, asgn2] : problem.getAssignments())
+                if(asgn1.getSlot(namedSlot).component < asgn2.getSlot(namedSlot).component) {
+                    ostr << " (not (and ";
+                    holds(asgn1, 0);
+                    ostr << ' ';
+                    holds(asgn2, 1);
+                    ostr << "))";
+                }
+        ostr << ')';
     }
 
 }
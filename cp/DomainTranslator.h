@@ -0,0 +1,748 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_DOMAINTRANSLATOR_H
+#define OMTSCHED_DOMAINTRANSLATOR_H
+
+#include "../Translator.h"
+#include "../conditions/BasicConditions.h"
+#include "../conditions/BooleanConditions.h"
+#include "../conditions/OrderedConditions.h"
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * Grounds a problem over finite domains, the common part of the translators that search natively.
+     * Every slot is a variable over the ordinals of the components of its type; optional assignments
+     * and weighted soft rules have a variable with the values 0 and 1.
+     * Rules are grounded as in the Boolean grounding, but negations are pushed down to tests of a single
+     * variable, e.g. ComponentIs holds for one component and InGroup for the members of the group.
+     * Above the tests is a graph of AND and OR nodes in which equal subformulas share one node.
+     * Top-level Distinct rules are kept as AllDifferent constraints for propagators of their own.
+     */
+    template<typename ID>
+    class DomainTranslator : public omtsched::Translator<ID> {
+
+    protected:
+        using Word = uint64_t;
+
+        enum class KIND {
+            ATOM, AND, OR
+        };
+
+        struct Variable {
+            // the values are 0 .. size - 1
+            size_t size = 0;
+            // paid if the variable is 0: an unfilled optional assignment or a violated soft rule
+            int cost = 0;
+            // activation of the slot's assignment, the slot does not matter while it is 0
+            int owner = -1;
+            // activation or soft rule
+            bool binary = false;
+            // the value of a fixed slot, -1 if it is not fixed
+            int fixed = -1;
+        };
+
+        // an ATOM holds if its variable takes one of the values in mask, AND and OR combine their children
+        struct Node {
+            explicit Node(const KIND &kind, const int &var = -1, std::vector<Word> mask = {}) :
+                    kind{kind}, var{var}, mask{std::move(mask)} {}
+
+            KIND kind;
+            int var = -1;
+            std::vector<Word> mask;
+            std::vector<int> children;
+            std::vector<int> parents;
+        };
+
+        // at most one active assignment holds each component of the slot, unless the guard (a soft rule) is 0
+        struct AllDifferent {
+            int guard = -1;
+            // per assignment its activation (-1 if not optional) and its slot
+            std::vector<std::pair<int, int>> entries;
+            // per entry the type of its slot, per type the component of each ordinal and the reverse
+            std::vector<size_t> types;
+            std::vector<std::vector<size_t>> components;
+            std::vector<std::vector<int>> ordinals;
+        };
+
+        /**
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the native
+         * translators do not support, TranslatorZ3 solves those problems
+         */
+        explicit DomainTranslator(const Problem<ID> &problem);
+
+        int mkAtom(const int &var, std::vector<Word> mask);
+        // the variable takes value, or any other if not positive
+        int mkAtom(const int &var, const size_t &value, const bool &positive);
+        int mkGate(const KIND &kind, const std::vector<int> &children);
+        int mkAnd(const std::vector<int> &children);
+        int mkOr(const std::vector<int> &children);
+
+        size_t words(const int &var) const;
+        static size_t popcount(const Word &word);
+        static size_t lowest(const Word &word);
+
+        /**
+         * @param values a value for every variable, the slots of unfilled assignments are skipped
+         */
+        Model<ID> makeModel(const std::vector<size_t> &values) const;
+
+        std::map<std::pair<ID, ID>, int> slots;
+        std::map<ID, int> activations;
+        // the variable of each weighted soft rule by handle, 1 iff the rule is kept
+        std::map<size_t, int> softRules;
+
+        std::vector<Variable> vars;
+        std::vector<Node> nodes;
+        // nodes that have to hold unless the soft rule variable (or -1) is 0
+        std::vector<std::pair<int, int>> constraints;
+        std::vector<AllDifferent> distincts;
+        // a fixed slot holds a component of another type
+        bool infeasible = false;
+
+        static constexpr int TRUE = 0;
+        static constexpr int FALSE = 1;
+
+    private:
+
+        void setupVariables();
+        void setupRules();
+
+        int newVariable(const size_t &size, const int &cost = 0, const int &owner = -1, const bool &binary = false);
+
+        // adds the condition as constraints that hold unless the soft rule variable guard is 0
+        void require(const std::shared_ptr<Condition<ID>> &condition, const int &guard);
+        void addConstraint(const int &node, const int &guard);
+        void addDistinct(const ID &slot, const int &guard);
+
+        // a node equivalent to the condition, or to its negation if not positive
+        int build(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> *asgn, const bool &positive);
+
+        int isActive(const Assignment<ID> &asgn, const bool &positive);
+        int isComponent(const Assignment<ID> &asgn, const ID &slot, const ID &component, const bool &positive);
+        int isInGroup(const Assignment<ID> &asgn, const ID &slot, const ID &group, const bool &positive);
+
+        // an active assignment that fulfills one of the conditions, and the negation
+        std::pair<int, int> holds(const Assignment<ID> &asgn, const std::vector<std::shared_ptr<Condition<ID>>> &conditions);
+
+        // the triples of Blocked and the pairs of Greater as clauses, each literal as (node, negation)
+        std::vector<std::vector<std::pair<int, int>>> getOrderClauses(const std::shared_ptr<Condition<ID>> &condition);
+
+        // per component, the assignments that hold it while active, for Distinct below the top level
+        std::map<ID, std::vector<std::pair<int, int>>> getHolders(const ID &slot);
+
+        std::vector<const Assignment<ID> *> getOrder(const ID &namedSlot) const;
+
+        std::map<ID, size_t> ordinals;
+
+        // nodes by kind and children or variable and mask
+        std::map<std::vector<Word>, int> shared;
+
+    };
+
+    template<typename ID>
+    DomainTranslator<ID>::DomainTranslator(const Problem<ID> &problem) : Translator<ID>{problem} {
+
+        // the constants: an empty AND and an empty OR
+        nodes.push_back(Node{KIND::AND});
+        nodes.push_back(Node{KIND::OR});
+
+        setupVariables();
+        setupRules();
+    }
+
+    template<typename ID>
+    void DomainTranslator<ID>::setupVariables() {
+
+        const Problem<ID> &problem = this->problem;
+
+        for(const ID &type : problem.getComponentTypes()) {
+            size_t ordinal = 0;
+            for(const auto &component : problem.getComponents(type))
+                ordinals.emplace(component->getID(), ordinal++);
+        }
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            int activation = -1;
+            if(asgn.isOptional()) {
+                if(asgn.getWeight() < 0)
+                    throw std::invalid_argument("weights of optional assignments cannot be negative");
+                activation = newVariable(2, asgn.getWeight(), -1, true);
+                activations.emplace(aid, activation);
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                const auto &components = problem.getComponents(slot.type);
+
+                // a slot of an empty type has a placeholder value and cannot be active
+                const int var = newVariable(std::max<size_t>(components.size(), 1), 0, activation);
+                slots.emplace(std::make_pair(aid, sid), var);
+
+                if(components.empty())
+                    addConstraint(isActive(asgn, false), -1);
+
+                if(slot.fixed) {
+                    const auto it = ordinals.find(slot.component);
+                    if(it == ordinals.end() || it->second >= components.size() || components.at(it->second)->getID() != slot.component)
+                        infeasible = true;
+                    else
+                        vars.at(var).fixed = (int) it->second;
+                }
+            }
+        }
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+        for(size_t handle = 0; handle < rules.size(); handle++) {
+
+            const Rule<ID> &rule = rules.at(handle);
+
+            // violating a soft rule without weight costs nothing, so it needs no variable
+            if(!rule.isOptional() || rule.getWeight() == 0)
+                continue;
+
+            if(rule.getWeight() < 0)
+                throw std::invalid_argument("weights of soft rules cannot be negative");
+            softRules.emplace(handle, newVariable(2, rule.getWeight(), -1, true));
+        }
+    }
+
+    template<typename ID>
+    void DomainTranslator<ID>::setupRules() {
+
+        const std::vector<Rule<ID>> &rules = this->problem.getRules();
+
+        for(size_t handle = 0; handle < rules.size(); handle++) {
+
+            const Rule<ID> &rule = rules.at(handle);
+
+            if(!rule.isOptional())
+                require(rule.getTopCondition(), -1);
+            else if(softRules.count(handle))
+                require(rule.getTopCondition(), softRules.at(handle));
+        }
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::newVariable(const size_t &size, const int &cost, const int &owner, const bool &binary) {
+
+        Variable var;
+        var.size = size;
+        var.cost = cost;
+        var.owner = owner;
+        var.binary = binary;
+        vars.push_back(var);
+
+        return (int) vars.size() - 1;
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::mkAtom(const int &var, std::vector<Word> mask) {
+
+        const size_t n = words(var);
+        const size_t size = vars.at(var).size;
+
+        mask.resize(n, 0);
+        if(size % 64 != 0)
+            mask.back() &= (Word{1} << (size % 64)) - 1;
+
+        // the test of a fixed slot is decided, so rules about other assignments vanish
+        const int fixed = vars.at(var).fixed;
+        if(fixed >= 0)
+            return (mask.at(fixed / 64) >> (fixed % 64)) & 1 ? TRUE : FALSE;
+
+        size_t count = 0;
+        for(const Word &word : mask)
+            count += popcount(word);
+
+        if(count == 0)
+            return FALSE;
+        if(count == size)
+            return TRUE;
+
+        std::vector<Word> key {(Word) KIND::ATOM, (Word) var};
+        key.insert(key.end(), mask.begin(), mask.end());
+
+        const auto it = shared.find(key);
+        if(it != shared.end())
+            return it->second;
+
+        Node node {KIND::ATOM, var, std::move(mask)};
+        nodes.push_back(std::move(node));
+        shared.emplace(std::move(key), (int) nodes.size() - 1);
+
+        return (int) nodes.size() - 1;
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::mkAtom(const int &var, const size_t &value, const bool &positive) {
+
+        std::vector<Word> mask(words(var), positive ? 0 : ~Word{0});
+        mask.at(value / 64) ^= Word{1} << (value % 64);
+
+        return mkAtom(var, std::move(mask));
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::mkGate(const KIND &kind, const std::vector<int> &children) {
+
+        // TRUE is the empty AND and FALSE the empty OR, the other constant decides the gate
+        const int identity = kind == KIND::AND ? TRUE : FALSE;
+        const int absorbing = kind == KIND::AND ? FALSE : TRUE;
+
+        std::vector<int> flat;
+        // tests of the same variable are merged into one, by intersection below an AND and union below an OR
+        std::map<int, std::vector<Word>> tests;
+        bool absorbed = false;
+
+        const auto add = [&](const int &child) {
+
+            const Node &node = nodes.at(child);
+
+            if(child == absorbing)
+                absorbed = true;
+            else if(node.kind == KIND::ATOM) {
+                auto it = tests.find(node.var);
+                if(it == tests.end())
+                    tests.emplace(node.var, node.mask);
+                else
+                    for(size_t w = 0; w < node.mask.size(); w++)
+                        it->second.at(w) = kind == KIND::AND ? it->second.at(w) & node.mask.at(w) : it->second.at(w) | node.mask.at(w);
+            }
+            else
+                flat.push_back(child);
+        };
+
+        for(const int &child : children) {
+            if(nodes.at(child).kind == kind)
+                for(const int &grandchild : std::vector<int>(nodes.at(child).children))
+                    add(grandchild);
+            else
+                add(child);
+        }
+
+        for(auto &[var, mask] : tests) {
+            const int test = mkAtom(var, std::move(mask));
+            if(test == absorbing)
+                absorbed = true;
+            else if(test != identity)
+                flat.push_back(test);
+        }
+
+        if(absorbed)
+            return absorbing;
+
+        std::sort(flat.begin(), flat.end());
+        flat.erase(std::unique(flat.begin(), flat.end()), flat.end());
+
+        if(flat.empty())
+            return identity;
+        if(flat.size() == 1)
+            return flat.front();
+
+        std::vector<Word> key {(Word) kind};
+        key.insert(key.end(), flat.begin(), flat.end());
+
+        const auto it = shared.find(key);
+        if(it != shared.end())
+            return it->second;
+
+        const int gate = (int) nodes.size();
+        for(const int &child : flat)
+            nodes.at(child).parents.push_back(gate);
+
+        Node node {kind};
+        node.children = std::move(flat);
+        nodes.push_back(std::move(node));
+        shared.emplace(std::move(key), gate);
+
+        return gate;
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::mkAnd(const std::vector<int> &children) {
+        return mkGate(KIND::AND, children);
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::mkOr(const std::vector<int> &children) {
+        return mkGate(KIND::OR, children);
+    }
+
+    template<typename ID>
+    void DomainTranslator<ID>::require(const std::shared_ptr<Condition<ID>> &condition, const int &guard) {
+
+        // rules that are conjunctions anyway become several constraints
+        switch(condition->getType()) {
+
+            case CONDITION_TYPE::AND:
+                for(const auto &subcondition : condition->subconditions)
+                    require(subcondition, guard);
+                return;
+
+            case CONDITION_TYPE::COMPONENT_IS:
+            case CONDITION_TYPE::IN_GROUP: {
+                const ID &slot = condition->getType() == CONDITION_TYPE::COMPONENT_IS
+                                 ? std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->componentSlot
+                                 : std::dynamic_pointer_cast<InGroup<ID>>(condition)->slot;
+
+                for(const auto &[aid, asgn] : this->problem.getAssignments())
+                    if(asgn.getComponentSlots().count(slot))
+                        addConstraint(mkOr({isActive(asgn, false), build(condition, &asgn, true)}), guard);
+                return;
+            }
+
+            case CONDITION_TYPE::IMPLIES:
+                for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+                    // most assignments do not fulfill the premise, e.g. by a fixed slot, and need no consequence
+                    const int premise = mkOr({isActive(asgn, false), build(condition->subconditions.at(0), &asgn, false)});
+                    if(premise != TRUE)
+                        addConstraint(mkOr({premise, build(condition->subconditions.at(1), &asgn, true)}), guard);
+                }
+                return;
+
+            case CONDITION_TYPE::DISTINCT:
+                addDistinct(std::dynamic_pointer_cast<Distinct<ID>>(condition)->componentSlot, guard);
+                return;
+
+            case CONDITION_TYPE::BLOCKED:
+            case CONDITION_TYPE::GREATER:
+                for(const auto &clause : getOrderClauses(condition)) {
+                    std::vector<int> literals;
+                    for(const auto &[literal, negation] : clause)
+                        literals.push_back(literal);
+                    addConstraint(mkOr(literals), guard);
+                }
+                return;
+
+            default:
+                addConstraint(build(condition, nullptr, true), guard);
+        }
+    }
+
+    template<typename ID>
+    void DomainTranslator<ID>::addConstraint(const int &node, const int &guard) {
+
+        if(node != TRUE)
+            constraints.emplace_back(node, guard);
+    }
+
+    template<typename ID>
+    void DomainTranslator<ID>::addDistinct(const ID &slot, const int &guard) {
+
+        const Problem<ID> &problem = this->problem;
+
+        AllDifferent distinct;
+        distinct.guard = guard;
+
+        // the components of all types in the slot, numbered in the order they are met
+        std::map<ID, size_t> components;
+        std::map<ID, size_t> types;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            if(!asgn.getComponentSlots().count(slot))
+                continue;
+
+            // an assignment with an empty type is never active
+            const ID &type = asgn.getSlot(slot).type;
+            if(problem.getComponents(type).empty())
+                continue;
+
+            auto it = types.find(type);
+            if(it == types.end()) {
+                it = types.emplace(type, distinct.components.size()).first;
+                distinct.components.emplace_back();
+                for(const auto &component : problem.getComponents(type))
+                    distinct.components.back().push_back(components.emplace(component->getID(), components.size()).first->second);
+            }
+
+            distinct.entries.emplace_back(asgn.isOptional() ? activations.at(aid) : -1, slots.at(std::make_pair(aid, slot)));
+            distinct.types.push_back(it->second);
+        }
+
+        if(distinct.entries.size() < 2)
+            return;
+
+        for(const std::vector<size_t> &type : distinct.components) {
+            distinct.ordinals.emplace_back(components.size(), -1);
+            for(size_t ordinal = 0; ordinal < type.size(); ordinal++)
+                distinct.ordinals.back().at(type.at(ordinal)) = (int) ordinal;
+        }
+
+        distincts.push_back(std::move(distinct));
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::build(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> *asgn, const bool &positive) {
+
+        // a conjunction of the parts holds, or the disjunction of their negations
+        const KIND all = positive ? KIND::AND : KIND::OR;
+        const KIND any = positive ? KIND::OR : KIND::AND;
+
+        std::vector<int> children;
+
+        switch(condition->getType()) {
+
+            case CONDITION_TYPE::NOT:
+                return build(condition->subconditions.at(0), asgn, !positive);
+
+            case CONDITION_TYPE::AND:
+            case CONDITION_TYPE::OR:
+                for(const auto &subcondition : condition->subconditions)
+                    children.push_back(build(subcondition, asgn, positive));
+                return mkGate(condition->getType() == CONDITION_TYPE::AND ? all : any, children);
+
+            case CONDITION_TYPE::XOR:
+            case CONDITION_TYPE::IFF: {
+                const auto &first = condition->subconditions.at(0);
+                const auto &second = condition->subconditions.at(1);
+
+                if((condition->getType() == CONDITION_TYPE::XOR) == positive)
+                    return mkOr({mkAnd({build(first, asgn, true), build(second, asgn, false)}),
+                                 mkAnd({build(first, asgn, false), build(second, asgn, true)})});
+
+                return mkOr({mkAnd({build(first, asgn, true), build(second, asgn, true)}),
+                             mkAnd({build(first, asgn, false), build(second, asgn, false)})});
+            }
+
+            // instantiated for every assignment, also below the top level
+            case CONDITION_TYPE::IMPLIES:
+                for(const auto &[aid, a] : this->problem.getAssignments())
+                    children.push_back(mkGate(any, {isActive(a, !positive), build(condition->subconditions.at(0), &a, !positive),
+                                                    build(condition->subconditions.at(1), &a, positive)}));
+                return mkGate(all, children);
+
+            case CONDITION_TYPE::COMPONENT_IS:
+            case CONDITION_TYPE::IN_GROUP: {
+                const bool componentIs = condition->getType() == CONDITION_TYPE::COMPONENT_IS;
+                const auto instance = [&](const Assignment<ID> &a, const bool &holds) {
+                    if(componentIs) {
+                        const auto c = std::dynamic_pointer_cast<ComponentIs<ID>>(condition);
+                        return isComponent(a, c->componentSlot, c->component, holds);
+                    }
+                    const auto c = std::dynamic_pointer_cast<InGroup<ID>>(condition);
+                    return isInGroup(a, c->slot, c->group, holds);
+                };
+
+                if(asgn)
+                    return instance(*asgn, positive);
+
+                const ID &slot = componentIs ? std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->componentSlot
+                                             : std::dynamic_pointer_cast<InGroup<ID>>(condition)->slot;
+
+                for(const auto &[aid, a] : this->problem.getAssignments())
+                    if(a.getComponentSlots().count(slot))
+                        children.push_back(mkGate(any, {isActive(a, !positive), instance(a, positive)}));
+                return mkGate(all, children);
+            }
+
+            // compares combinations of assignments, rules only instantiate single ones so far
+            case CONDITION_TYPE::SAME_COMPONENT:
+                return positive ? TRUE : FALSE;
+
+            // below the top level the pairs are listed
+            case CONDITION_TYPE::DISTINCT:
+                for(const auto &[component, holders] : getHolders(std::dynamic_pointer_cast<Distinct<ID>>(condition)->componentSlot))
+                    for(size_t i = 0; i < holders.size(); i++)
+                        for(size_t j = i + 1; j < holders.size(); j++)
+                            children.push_back(positive ? mkOr({holders.at(i).second, holders.at(j).second})
+                                                        : mkAnd({holders.at(i).first, holders.at(j).first}));
+                return mkGate(all, children);
+
+            case CONDITION_TYPE::BLOCKED:
+            case CONDITION_TYPE::GREATER:
+                for(const auto &clause : getOrderClauses(condition)) {
+                    std::vector<int> literals;
+                    for(const auto &[literal, negation] : clause)
+                        literals.push_back(positive ? literal : negation);
+                    children.push_back(mkGate(any, literals));
+                }
+                return mkGate(all, children);
+
+            // a rule that is left out would let the search return models that violate it
+            default:
+                throw std::invalid_argument("condition type not supported by the native translators");
+        }
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::isActive(const Assignment<ID> &asgn, const bool &positive) {
+
+        if(!asgn.isOptional())
+            return positive ? TRUE : FALSE;
+
+        return mkAtom(activations.at(asgn.getID()), 1, positive);
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::isComponent(const Assignment<ID> &asgn, const ID &slot, const ID &component, const bool &positive) {
+
+        const auto &type = this->problem.getComponents(asgn.getSlot(slot).type);
+        const auto it = ordinals.find(component);
+
+        // a component of another type is never held
+        if(it == ordinals.end() || it->second >= type.size() || type.at(it->second)->getID() != component)
+            return positive ? FALSE : TRUE;
+
+        return mkAtom(slots.at(std::make_pair(asgn.getID(), slot)), it->second, positive);
+    }
+
+    template<typename ID>
+    int DomainTranslator<ID>::isInGroup(const Assignment<ID> &asgn, const ID &slot, const ID &group, const bool &positive) {
+
+        const int var = slots.at(std::make_pair(asgn.getID(), slot));
+        const auto &components = this->problem.getComponents(asgn.getSlot(slot).type);
+
+        std::vector<Word> mask(words(var), 0);
+        for(size_t i = 0; i < components.size(); i++)
+            if(components.at(i)->inGroup(group) == positive)
+                mask.at(i / 64) |= Word{1} << (i % 64);
+
+        // the placeholder of an empty type is in no group
+        if(components.empty() && !positive)
+            mask.front() = 1;
+
+        return mkAtom(var, std::move(mask));
+    }
+
+    template<typename ID>
+    std::pair<int, int> DomainTranslator<ID>::holds(const Assignment<ID> &asgn, const std::vector<std::shared_ptr<Condition<ID>>> &conditions) {
+
+        std::vector<int> fulfilled;
+        std::vector<int> violated;
+        for(const auto &condition : conditions) {
+            fulfilled.push_back(build(condition, &asgn, true));
+            violated.push_back(build(condition, &asgn, false));
+        }
+
+        return {mkAnd({isActive(asgn, true), mkOr(fulfilled)}), mkOr({isActive(asgn, false), mkAnd(violated)})};
+    }
+
+    template<typename ID>
+    std::vector<std::vector<std::pair<int, int>>> DomainTranslator<ID>::getOrderClauses(const std::shared_ptr<Condition<ID>> &condition) {
+
+        std::vector<std::vector<std::pair<int, int>>> result;
+
+        const auto negate = [](const std::pair<int, int> &literal) {
+            return std::make_pair(literal.second, literal.first);
+        };
+
+        if(condition->getType() == CONDITION_TYPE::BLOCKED) {
+
+            const std::vector<const Assignment<ID> *> order = getOrder(std::dynamic_pointer_cast<Blocked<ID>>(condition)->getNamedSlot());
+
+            std::vector<std::pair<int, int>> fulfilled;
+            for(const Assignment<ID> *asgn : order)
+                fulfilled.push_back(holds(*asgn, condition->subconditions));
+
+            // if two assignments fulfill the condition, so do all in between
+            for(size_t first = 0; first + 2 < order.size(); first++)
+                for(size_t last = first + 2; last < order.size(); last++)
+                    for(size_t between = first + 1; between < last; between++)
+                        result.push_back({negate(fulfilled.at(first)), negate(fulfilled.at(last)), fulfilled.at(between)});
+
+            return result;
+        }
+
+        const ID namedSlot = std::dynamic_pointer_cast<Greater<ID>>(condition)->getNamedSlot();
+
+        // no active assignment fulfilling the first condition comes before one fulfilling the second
+        for(const auto &[id1, asgn1] : this->problem.getAssignments())
+            for(const auto &[id2, asgn2] : this->problem.getAssignments())
+                if(asgn1.getSlot(namedSlot).component < asgn2.getSlot(namedSlot).component)
+                    result.push_back({negate(holds(asgn1, {condition->subconditions.at(0)})),
+                                      negate(holds(asgn2, {condition->subconditions.at(1)}))});
+
+        return result;
+    }
+
+    template<typename ID>
+    std::map<ID, std::vector<std::pair<int, int>>> DomainTranslator<ID>::getHolders(const ID &slot) {
+
+        std::map<ID, std::vector<std::pair<int, int>>> holders;
+
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            if(!asgn.getComponentSlots().count(slot))
+                continue;
+
+            for(const auto &component : this->problem.getComponents(asgn.getSlot(slot).type))
+                holders[component->getID()].emplace_back(
+                        mkAnd({isActive(asgn, true), isComponent(asgn, slot, component->getID(), true)}),
+                        mkOr({isActive(asgn, false), isComponent(asgn, slot, component->getID(), false)}));
+        }
+
+        return holders;
+    }
+
+    template<typename ID>
+    std::vector<const Assignment<ID> *> DomainTranslator<ID>::getOrder(const ID &namedSlot) const {
+
+        // by the component of the named slot, ties by ID
+        std::vector<std::pair<ID, const Assignment<ID> *>> order;
+        for(const auto &[aid, asgn] : this->problem.getAssignments())
+            order.emplace_back(asgn.getSlot(namedSlot).component, &asgn);
+        std::stable_sort(order.begin(), order.end(),
+                         [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+        std::vector<const Assignment<ID> *> assignments;
+        for(const auto &[component, asgn] : order)
+            assignments.push_back(asgn);
+
+        return assignments;
+    }
+
+    template<typename ID>
+    size_t DomainTranslator<ID>::words(const int &var) const {
+        return (vars.at(var).size + 63) / 64;
+    }
+
+    template<typename ID>
+    size_t DomainTranslator<ID>::popcount(const Word &word) {
+        return std::bitset<64>(word).count();
+    }
+
+    template<typename ID>
+    size_t DomainTranslator<ID>::lowest(const Word &word) {
+        return popcount((word & (~word + 1)) - 1);
+    }
+
+    template<typename ID>
+    Model<ID> DomainTranslator<ID>::makeModel(const std::vector<size_t> &values) const {
+
+        const Problem<ID> &problem = this->problem;
+        Model<ID> model;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            if(asgn.isOptional() && values.at(activations.at(aid)) == 0) {
+                model.addUnfilled(aid, asgn.getWeight());
+                continue;
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots())
+                model.setComponent(aid, sid, problem.getComponents(slot.type).at(values.at(slots.at(std::make_pair(aid, sid))))->getID());
+        }
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+        for(const auto &[handle, var] : softRules)
+            if(values.at(var) == 0)
+                model.addViolation(handle, rules.at(handle).getWeight());
+
+        return model;
+    }
+
+}
+
+#endif //OMTSCHED_DOMAINTRANSLATOR_H
@@ -0,0 +1,28 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_OPTIONSCP_H
+#define OMTSCHED_OPTIONSCP_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace omtsched {
+
+    struct OptionsCP {
+
+        // the search stops after this time and keeps the best model found so far, 0 for none
+        std::chrono::milliseconds timeout {0};
+
+        // failures before the first restart, the following runs are longer by the Luby sequence.
+        // Restarts keep the variable weights, 0 searches without restarts
+        size_t restartBase = 100;
+
+        // breaks ties between equally ranked variables at random, 0 takes the first of them
+        unsigned randomSeed = 0;
+    };
+
+}
+
+#endif //OMTSCHED_OPTIONSCP_H
@@ -0,0 +1,871 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_TRANSLATORCP_H
+#define OMTSCHED_TRANSLATORCP_H
+
+#include "DomainTranslator.h"
+#include "OptionsCP.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * Solves a problem natively by constraint propagation and backtracking search, without Z3.
+     * The domain of every variable of the grounding is kept as a bitset. A required test prunes the domain
+     * at once. The AND/OR graph above the tests propagates by counting false children, so a required OR
+     * with one child left requires that child. Implies becomes one such clause per assignment.
+     * Distinct has its own propagator that removes the component of an active, fixed slot from all the others.
+     * The search branches on the variable with the smallest domain per weighted degree (dom/wdeg); each failure
+     * raises the weights of the variables of the failed constraint. It restarts after a Luby sequence of failures
+     * and minimizes the penalty by branch and bound.
+     */
+    template<typename ID>
+    class TranslatorCP : public DomainTranslator<ID> {
+    public:
+        /**
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the native
+         * translators do not support, TranslatorZ3 solves those problems
+         */
+        TranslatorCP(const Problem<ID> &problem, const OptionsCP &options = {});
+
+        void solve() override;
+
+        /**
+         * Searches for a model with the least penalty, the result is kept
+         * @return true if a model was found
+         */
+        bool search();
+
+        Model<ID> getModel() override;
+
+        bool isSAT() override;
+
+        /**
+         * @return true if the search was completed: the model is optimal, or there is none
+         */
+        bool isProven() const;
+
+        /**
+         * Stops the search, which keeps the best model found so far. Can be called from any thread
+         */
+        void cancel();
+
+        size_t getDecisionCount() const;
+
+        size_t getFailureCount() const;
+
+        size_t getRestartCount() const;
+
+    private:
+        using Word = typename DomainTranslator<ID>::Word;
+        using KIND = typename DomainTranslator<ID>::KIND;
+        using Variable = typename DomainTranslator<ID>::Variable;
+        using Node = typename DomainTranslator<ID>::Node;
+        using AllDifferent = typename DomainTranslator<ID>::AllDifferent;
+
+        void setupState();
+
+        // ------------------------- propagation -------------------------
+
+        size_t countOf(const int &var) const;
+        bool contains(const int &var, const size_t &value) const;
+        size_t firstValue(const int &var) const;
+        bool isDisjoint(const int &var, const std::vector<Word> &mask) const;
+
+        // changes a word of state, recorded on the trail below the root
+        void set(const size_t &index, const Word &value);
+
+        bool restrict(const int &var, const std::vector<Word> &mask);
+        bool remove(const int &var, const size_t &value);
+        bool assign(const int &var, const size_t &value);
+        bool changed(const int &var, const size_t &count);
+
+        bool propagate();
+        void clearQueue();
+
+        bool isFalse(const int &node) const;
+        bool markFalse(const int &node);
+        bool onFalse(const int &node);
+        bool enforce(const int &node);
+        bool enforceLast(const int &node);
+
+        bool propagateDistinct(const size_t &distinct, const int &entry);
+        bool propagateEntry(const size_t &distinct, const size_t &entry, const bool &enforced);
+        // the entry must not hold the component
+        bool forbid(const size_t &distinct, const size_t &entry, const size_t &component);
+
+        bool propagateCost();
+
+        void blame(const int &var);
+        void blameNode(const int &node);
+
+        // ------------------------- search -------------------------
+
+        bool initialize();
+        int select();
+        size_t chooseValue(const int &var) const;
+        bool backtrack(size_t &failures);
+        void undo(const size_t &level);
+        bool isStopped() const;
+
+        static size_t luby(size_t i);
+
+        const OptionsCP options;
+
+        // the constraints, those of soft rules hold if the rule's variable is 0
+        std::vector<int> roots;
+        // the variables with a cost by descending weight
+        std::vector<std::pair<int, int>> costs;
+
+        // domains, node counters and flags, Distinct holders and the penalty paid so far
+        std::vector<Word> state;
+        std::vector<std::pair<size_t, Word>> trail;
+        std::vector<size_t> levels;
+        std::vector<std::pair<int, size_t>> decisions;
+        // per variable the first word of its domain, followed by the number of values left
+        std::vector<size_t> offsets;
+        // per node its number of false children and whether it is required, from nodeBase
+        size_t nodeBase = 0;
+        // per Distinct the entry + 1 that holds each component for sure
+        std::vector<size_t> holders;
+        size_t lowerBound = 0;
+
+        std::vector<std::vector<int>> atomWatchers;
+        std::vector<std::vector<std::pair<size_t, int>>> distinctWatchers;
+        std::vector<int> queue;
+        std::vector<char> queued;
+
+        std::vector<unsigned long> weights;
+        std::mt19937 random;
+
+        std::vector<size_t> best;
+        int bestCost = 0;
+        bool searched = false;
+        bool proven = false;
+
+        std::atomic<bool> cancelled {false};
+        std::chrono::steady_clock::time_point deadline;
+
+        size_t decisionCount = 0;
+        size_t failureCount = 0;
+        size_t restartCount = 0;
+
+    };
+
+    template<typename ID>
+    TranslatorCP<ID>::TranslatorCP(const Problem<ID> &problem, const OptionsCP &options) :
+    DomainTranslator<ID>{problem}, options{options}, random{options.randomSeed} {
+        setupState();
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::setupState() {
+
+        const std::vector<Variable> &vars = this->vars;
+
+        // a soft rule holds if its variable is 0, which adds nodes before the state is laid out
+        for(const auto &[node, guard] : this->constraints)
+            roots.push_back(guard < 0 ? node : this->mkOr({this->mkAtom(guard, 0, true), node}));
+
+        for(size_t var = 0; var < vars.size(); var++) {
+
+            offsets.push_back(state.size());
+
+            const Variable &v = vars.at(var);
+            const size_t n = this->words((int) var);
+
+            for(size_t w = 0; w < n; w++) {
+                if(v.fixed >= 0)
+                    state.push_back((size_t) v.fixed / 64 == w ? Word{1} << (v.fixed % 64) : 0);
+                else
+                    state.push_back(w + 1 < n || v.size % 64 == 0 ? ~Word{0} : (Word{1} << (v.size % 64)) - 1);
+            }
+            state.push_back(v.fixed >= 0 ? 1 : v.size);
+        }
+
+        const std::vector<Node> &nodes = this->nodes;
+        const std::vector<AllDifferent> &distincts = this->distincts;
+
+        nodeBase = state.size();
+        state.resize(nodeBase + 2 * nodes.size(), 0);
+
+        for(const AllDifferent &distinct : distincts) {
+            holders.push_back(state.size());
+            state.resize(state.size() + distinct.ordinals.front().size(), 0);
+        }
+
+        lowerBound = state.size();
+        state.push_back(0);
+
+        atomWatchers.resize(vars.size());
+        distinctWatchers.resize(vars.size());
+
+        // a test that no other node uses is only ever required, which prunes the domain once
+        for(size_t node = 0; node < nodes.size(); node++)
+            if(nodes.at(node).kind == KIND::ATOM && !nodes.at(node).parents.empty())
+                atomWatchers.at(nodes.at(node).var).push_back((int) node);
+
+        for(size_t d = 0; d < distincts.size(); d++) {
+            const AllDifferent &distinct = distincts.at(d);
+            for(size_t entry = 0; entry < distinct.entries.size(); entry++) {
+                if(distinct.entries.at(entry).first >= 0)
+                    distinctWatchers.at(distinct.entries.at(entry).first).emplace_back(d, (int) entry);
+                distinctWatchers.at(distinct.entries.at(entry).second).emplace_back(d, (int) entry);
+            }
+            if(distinct.guard >= 0)
+                distinctWatchers.at(distinct.guard).emplace_back(d, -1);
+        }
+
+        for(size_t var = 0; var < vars.size(); var++)
+            if(vars.at(var).cost > 0)
+                costs.emplace_back((int) var, vars.at(var).cost);
+        std::stable_sort(costs.begin(), costs.end(), [](const auto &lhs, const auto &rhs) { return lhs.second > rhs.second; });
+
+        queued.assign(vars.size(), 0);
+        weights.assign(vars.size(), 1);
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::countOf(const int &var) const {
+        return state[offsets[var] + this->words(var)];
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::contains(const int &var, const size_t &value) const {
+        return (state[offsets[var] + value / 64] >> (value % 64)) & 1;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::firstValue(const int &var) const {
+
+        const size_t offset = offsets[var];
+        for(size_t w = 0; w < this->words(var); w++)
+            if(state[offset + w] != 0)
+                return w * 64 + this->lowest(state[offset + w]);
+
+        return 0;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::isDisjoint(const int &var, const std::vector<Word> &mask) const {
+
+        const size_t offset = offsets[var];
+        for(size_t w = 0; w < mask.size(); w++)
+            if(state[offset + w] & mask[w])
+                return false;
+
+        return true;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::set(const size_t &index, const Word &value) {
+
+        if(!levels.empty())
+            trail.emplace_back(index, state[index]);
+
+        state[index] = value;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::restrict(const int &var, const std::vector<Word> &mask) {
+
+        const size_t offset = offsets[var];
+
+        bool modified = false;
+        size_t count = 0;
+        for(size_t w = 0; w < mask.size(); w++) {
+            const Word word = state[offset + w] & mask[w];
+            if(word != state[offset + w]) {
+                set(offset + w, word);
+                modified = true;
+            }
+            count += this->popcount(word);
+        }
+
+        return !modified || changed(var, count);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::remove(const int &var, const size_t &value) {
+
+        if(!contains(var, value))
+            return true;
+
+        const size_t index = offsets[var] + value / 64;
+        set(index, state[index] & ~(Word{1} << (value % 64)));
+
+        return changed(var, countOf(var) - 1);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::assign(const int &var, const size_t &value) {
+
+        if(!contains(var, value)) {
+            blame(var);
+            return false;
+        }
+
+        if(countOf(var) == 1)
+            return true;
+
+        const size_t offset = offsets[var];
+        for(size_t w = 0; w < this->words(var); w++) {
+            const Word word = w == value / 64 ? Word{1} << (value % 64) : 0;
+            if(word != state[offset + w])
+                set(offset + w, word);
+        }
+
+        return changed(var, 1);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::changed(const int &var, const size_t &count) {
+
+        if(count == 0) {
+            blame(var);
+            return false;
+        }
+
+        set(offsets[var] + this->words(var), count);
+
+        if(!queued[var]) {
+            queued[var] = 1;
+            queue.push_back(var);
+        }
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::propagate() {
+
+        for(size_t head = 0; head < queue.size(); head++) {
+
+            const int var = queue[head];
+            queued[var] = 0;
+
+            for(const int &atom : atomWatchers[var])
+                if(state[nodeBase + 2 * atom] == 0 && isDisjoint(var, this->nodes[atom].mask) && !markFalse(atom)) {
+                    clearQueue();
+                    return false;
+                }
+
+            for(const auto &[distinct, entry] : distinctWatchers[var])
+                if(!propagateDistinct(distinct, entry)) {
+                    clearQueue();
+                    return false;
+                }
+
+            // a binary variable loses 1 only once, then its cost is paid
+            if(this->vars[var].cost > 0 && !contains(var, 1)) {
+                set(lowerBound, state[lowerBound] + this->vars[var].cost);
+                if(!propagateCost()) {
+                    clearQueue();
+                    return false;
+                }
+            }
+        }
+
+        queue.clear();
+        return true;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::clearQueue() {
+
+        for(const int &var : queue)
+            queued[var] = 0;
+        queue.clear();
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::isFalse(const int &node) const {
+
+        // an OR is false if all children are, an AND and a test if one is
+        const Word count = state[nodeBase + 2 * node];
+        return this->nodes[node].kind == KIND::OR ? count >= this->nodes[node].children.size() : count > 0;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::markFalse(const int &node) {
+
+        set(nodeBase + 2 * node, 1);
+        return onFalse(node);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::onFalse(const int &node) {
+
+        if(state[nodeBase + 2 * node + 1]) {
+            blameNode(node);
+            return false;
+        }
+
+        for(const int &parent : this->nodes[node].parents) {
+
+            const Word count = state[nodeBase + 2 * parent] + 1;
+            set(nodeBase + 2 * parent, count);
+
+            const size_t size = this->nodes[parent].children.size();
+
+            if(this->nodes[parent].kind == KIND::AND) {
+                if(count == 1 && !onFalse(parent))
+                    return false;
+            }
+            else if(count == size) {
+                if(!onFalse(parent))
+                    return false;
+            }
+            else if(count + 1 == size && state[nodeBase + 2 * parent + 1] && !enforceLast(parent))
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::enforce(const int &node) {
+
+        if(state[nodeBase + 2 * node + 1])
+            return true;
+
+        set(nodeBase + 2 * node + 1, 1);
+
+        if(isFalse(node)) {
+            blameNode(node);
+            return false;
+        }
+
+        const Node &n = this->nodes[node];
+
+        switch(n.kind) {
+
+            case KIND::ATOM:
+                return restrict(n.var, n.mask);
+
+            case KIND::AND:
+                for(const int &child : n.children)
+                    if(!enforce(child))
+                        return false;
+                return true;
+
+            default:
+                return state[nodeBase + 2 * node] + 1 != n.children.size() || enforceLast(node);
+        }
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::enforceLast(const int &node) {
+
+        // the one child of a required OR that is not false yet
+        for(const int &child : this->nodes[node].children)
+            if(!isFalse(child))
+                return enforce(child);
+
+        blameNode(node);
+        return false;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::propagateDistinct(const size_t &distinct, const int &entry) {
+
+        const AllDifferent &d = this->distincts[distinct];
+
+        // a violated soft rule does not count, one that may still be violated only records the holders
+        if(d.guard >= 0 && !contains(d.guard, 1))
+            return true;
+
+        const bool enforced = d.guard < 0 || !contains(d.guard, 0);
+
+        if(entry >= 0)
+            return propagateEntry(distinct, entry, enforced);
+
+        for(size_t e = 0; e < d.entries.size(); e++)
+            if(!propagateEntry(distinct, e, enforced))
+                return false;
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::propagateEntry(const size_t &distinct, const size_t &entry, const bool &enforced) {
+
+        const AllDifferent &d = this->distincts[distinct];
+        const auto &[activation, slot] = d.entries[entry];
+
+        if(activation >= 0 && !contains(activation, 1))
+            return true;
+
+        const bool active = activation < 0 || !contains(activation, 0);
+        const std::vector<size_t> &components = d.components[d.types[entry]];
+
+        if(active && countOf(slot) == 1) {
+
+            const size_t component = components[firstValue(slot)];
+            const Word holder = state[holders[distinct] + component];
+
+            if(holder != 0 && holder != entry + 1) {
+                if(!enforced)
+                    return remove(d.guard, 1);
+
+                blame(slot);
+                blame(d.entries[holder - 1].second);
+                return false;
+            }
+
+            set(holders[distinct] + component, entry + 1);
+
+            if(!enforced)
+                return true;
+
+            for(size_t other = 0; other < d.entries.size(); other++)
+                if(other != entry && !forbid(distinct, other, component))
+                    return false;
+
+            return true;
+        }
+
+        if(!enforced)
+            return true;
+
+        // an active slot loses the components that are held for sure
+        if(active) {
+            std::vector<size_t> held;
+            for(size_t ordinal = 0; ordinal < components.size(); ordinal++)
+                if(contains(slot, ordinal) && state[holders[distinct] + components[ordinal]] != 0)
+                    held.push_back(ordinal);
+
+            for(const size_t &ordinal : held)
+                if(!remove(slot, ordinal))
+                    return false;
+
+            return true;
+        }
+
+        // a slot left with a component that is held cannot become active
+        if(countOf(slot) == 1 && state[holders[distinct] + components[firstValue(slot)]] != 0)
+            return remove(activation, 1);
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::forbid(const size_t &distinct, const size_t &entry, const size_t &component) {
+
+        const AllDifferent &d = this->distincts[distinct];
+        const auto &[activation, slot] = d.entries[entry];
+
+        const int ordinal = d.ordinals[d.types[entry]][component];
+        if(ordinal < 0 || (activation >= 0 && !contains(activation, 1)))
+            return true;
+
+        if(activation < 0 || !contains(activation, 0))
+            return remove(slot, ordinal);
+
+        if(countOf(slot) == 1 && contains(slot, ordinal))
+            return remove(activation, 1);
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::propagateCost() {
+
+        if(best.empty())
+            return true;
+
+        const long paid = (long) state[lowerBound];
+        if(paid >= bestCost)
+            return false;
+
+        // a penalty that would reach the best model's cannot be paid anymore
+        for(const auto &[var, weight] : costs) {
+            if(paid + weight < bestCost)
+                break;
+            if(contains(var, 0) && contains(var, 1) && !remove(var, 0))
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::blame(const int &var) {
+        weights[var]++;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::blameNode(const int &node) {
+
+        if(this->nodes[node].kind == KIND::ATOM) {
+            blame(this->nodes[node].var);
+            return;
+        }
+
+        for(const int &child : this->nodes[node].children)
+            if(this->nodes[child].kind == KIND::ATOM)
+                blame(this->nodes[child].var);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::initialize() {
+
+        if(this->infeasible)
+            return false;
+
+        // tests already false by the fixed slots
+        for(size_t node = 0; node < this->nodes.size(); node++)
+            if(this->nodes[node].kind == KIND::ATOM && isDisjoint(this->nodes[node].var, this->nodes[node].mask) && !markFalse((int) node))
+                return false;
+
+        for(const int &root : roots)
+            if(!enforce(root))
+                return false;
+
+        for(size_t distinct = 0; distinct < this->distincts.size(); distinct++)
+            if(!propagateDistinct(distinct, -1))
+                return false;
+
+        return propagate();
+    }
+
+    template<typename ID>
+    int TranslatorCP<ID>::select() {
+
+        // the smallest domain per weighted degree, the slots of inactive assignments are left alone
+        int chosen = -1;
+        size_t ties = 0;
+
+        for(int var = 0; var < (int) this->vars.size(); var++) {
+
+            const size_t count = countOf(var);
+            if(count <= 1 || (this->vars[var].owner >= 0 && !contains(this->vars[var].owner, 1)))
+                continue;
+
+            if(chosen < 0) {
+                chosen = var;
+                ties = 1;
+                continue;
+            }
+
+            const unsigned long lhs = count * weights[chosen];
+            const unsigned long rhs = countOf(chosen) * weights[var];
+
+            if(lhs < rhs) {
+                chosen = var;
+                ties = 1;
+            }
+            else if(lhs == rhs && options.randomSeed != 0 && random() % ++ties == 0)
+                chosen = var;
+        }
+
+        return chosen;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::chooseValue(const int &var) const {
+
+        // the value of the best model first, then no penalty
+        if(!best.empty() && contains(var, best[var]))
+            return best[var];
+
+        if(this->vars[var].binary && contains(var, 1))
+            return 1;
+
+        return firstValue(var);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::backtrack(size_t &failures) {
+
+        // the last decision is refuted one level up, which may fail in turn
+        while(!decisions.empty()) {
+
+            const auto [var, value] = decisions.back();
+            decisions.pop_back();
+            undo(decisions.size());
+
+            if(remove(var, value) && propagate())
+                return true;
+
+            failureCount++;
+            failures++;
+        }
+
+        return false;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::undo(const size_t &level) {
+
+        clearQueue();
+
+        if(level >= levels.size())
+            return;
+
+        while(trail.size() > levels.at(level)) {
+            state[trail.back().first] = trail.back().second;
+            trail.pop_back();
+        }
+
+        levels.resize(level);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::isStopped() const {
+        return cancelled || (options.timeout.count() > 0 && std::chrono::steady_clock::now() >= deadline);
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::search() {
+
+        if(searched)
+            return !best.empty();
+
+        searched = true;
+        deadline = std::chrono::steady_clock::now() + options.timeout;
+
+        if(!initialize()) {
+            proven = true;
+            return false;
+        }
+
+        size_t failures = 0;
+        size_t limit = options.restartBase;
+
+        while(!isStopped()) {
+
+            const int var = select();
+
+            if(var < 0) {
+
+                // a model, the following ones have to be cheaper
+                best.resize(this->vars.size());
+                for(size_t v = 0; v < this->vars.size(); v++)
+                    best[v] = firstValue((int) v);
+                bestCost = (int) state[lowerBound];
+
+                undo(0);
+                decisions.clear();
+
+                if(bestCost == 0 || !propagateCost() || !propagate()) {
+                    proven = true;
+                    break;
+                }
+                continue;
+            }
+
+            decisionCount++;
+
+            const size_t value = chooseValue(var);
+            levels.push_back(trail.size());
+            decisions.emplace_back(var, value);
+
+            if(assign(var, value) && propagate())
+                continue;
+
+            failureCount++;
+            failures++;
+
+            if(!backtrack(failures)) {
+                proven = true;
+                break;
+            }
+
+            if(options.restartBase > 0 && failures >= limit) {
+                undo(0);
+                decisions.clear();
+                restartCount++;
+                failures = 0;
+                limit = options.restartBase * luby(restartCount + 1);
+            }
+        }
+
+        undo(0);
+        decisions.clear();
+
+        return !best.empty();
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::solve() {
+
+        if(search())
+            std::cout << "SAT" << std::endl;
+        else if(proven)
+            std::cout << "UNSAT" << std::endl;
+        else
+            std::cout << "UNKNOWN" << std::endl;
+    }
+
+    template<typename ID>
+    Model<ID> TranslatorCP<ID>::getModel() {
+
+        if(!search())
+            return Model<ID>{};
+
+        Model<ID> model = this->makeModel(best);
+
+        if(proven)
+            model.setLowerBound(model.getPenalty());
+
+        return model;
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::isSAT() {
+        return search();
+    }
+
+    template<typename ID>
+    bool TranslatorCP<ID>::isProven() const {
+        return proven;
+    }
+
+    template<typename ID>
+    void TranslatorCP<ID>::cancel() {
+        cancelled = true;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::getDecisionCount() const {
+        return decisionCount;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::getFailureCount() const {
+        return failureCount;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::getRestartCount() const {
+        return restartCount;
+    }
+
+    template<typename ID>
+    size_t TranslatorCP<ID>::luby(size_t i) {
+
+        // 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+        while(true) {
+            size_t k = 1;
+            while((size_t{1} << k) - 1 < i)
+                k++;
+
+            if(i == (size_t{1} << k) - 1)
+                return size_t{1} << (k - 1);
+
+            i -= (size_t{1} << (k - 1)) - 1;
+        }
+    }
+
+}
+
+#endif //OMTSCHED_TRANSLATORCP_H
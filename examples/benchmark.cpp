@@ -0,0 +1,95 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#include "../omtsched.h"
+#include "zebra.cpp"
+#include <chrono>
+#include <functional>
+
+// Compares the sort encodings of the Z3 translator, with and without the minimal
+// encoding, on a few instance families.
+// For every instance and encoding the time for grounding and for solving is reported,
+// followed by the time and goal sizes of each step of a preprocessing pipeline.
+
+using namespace omtsched;
+
+// A round-robin like instance with one large component type (T*(T-1) games),
+// similar to the game components of itc21.
+void getRoundRobin(Problem<std::string> &problem, const int &teams) {
+
+    const auto &gameT = problem.addComponentType("G");
+    const auto &roundT = problem.addComponentType("R");
+
+    for(int t1 = 0; t1 < teams; t1++)
+        for(int t2 = 0; t2 < teams; t2++)
+            if(t1 != t2)
+                problem.newComponent(std::to_string(t1) + "_" + std::to_string(t2), gameT);
+
+    for(int r = 0; r < teams * (teams - 1); r++) {
+        const auto &round = problem.newOrderedComponent(std::to_string(r), roundT, r);
+        auto &asgn = problem.newAssignment("r" + std::to_string(r));
+        asgn.setFixed("Round", round);
+        asgn.setVariable("Game", gameT, false);
+    }
+
+    problem.addRule(distinct<std::string>("Game"));
+    problem.addRule(implies(componentIs<std::string>("Round", "0"), componentIs<std::string>("Game", "0_1")));
+    problem.addRule(implies(componentIs<std::string>("Round", "1"), componentIs<std::string>("Game", "1_0")));
+}
+
+std::string encodingName(const SORT_ENCODING &encoding) {
+
+    switch (encoding) {
+        case SORT_ENCODING::ENUMERATION: return "enumeration";
+        case SORT_ENCODING::BITVECTOR: return "bit-vector";
+        case SORT_ENCODING::INTEGER: return "integer";
+        case SORT_ENCODING::ONE_HOT: return "one-hot";
+    }
+    return "";
+}
+
+void run(const std::string &name, const std::function<void(Problem<std::string>&)> &generate) {
+
+    using clock = std::chrono::steady_clock;
+
+    Problem<std::string> problem;
+    generate(problem);
+
+    for(const bool minimal : {false, true})
+    for(const SORT_ENCODING encoding : {SORT_ENCODING::ENUMERATION, SORT_ENCODING::BITVECTOR,
+                                        SORT_ENCODING::INTEGER, SORT_ENCODING::ONE_HOT}) {
+
+        OptionsZ3<std::string> options;
+        options.defaultEncoding = encoding;
+        options.minimalEncoding = minimal;
+
+        const auto start = clock::now();
+        TranslatorZ3<std::string> translator(problem, options);
+        const auto grounded = clock::now();
+        const bool sat = translator.isSAT();
+        const auto solved = clock::now();
+
+        std::cout << name << "\t" << encodingName(encoding) << (minimal ? " (minimal)" : "")
+                  << "\tground " << std::chrono::duration_cast<std::chrono::milliseconds>(grounded - start).count() << "ms"
+                  << "\tsolve " << std::chrono::duration_cast<std::chrono::milliseconds>(solved - grounded).count() << "ms"
+                  << "\t" << (sat ? "SAT" : "UNSAT/UNKNOWN") << std::endl;
+    }
+
+    // effect of a preprocessing pipeline on the default encoding
+    OptionsZ3<std::string> options;
+    options.preprocessing = {"simplify", "propagate-values", "solve-eqs", "elim-uncnstr"};
+
+    TranslatorZ3<std::string> translator(problem, options);
+    translator.isSAT();
+    translator.printTacticStatistics(std::cout);
+}
+
+int main() {
+
+    run("zebra", getZebra);
+
+    for(const int teams : {6, 8, 10})
+        run("roundrobin" + std::to_string(teams), [&teams](Problem<std::string> &p) { getRoundRobin(p, teams); });
+
+}
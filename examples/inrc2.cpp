@@ -32,6 +32,9 @@ int main() {
 
         std::string skill = v.second.data();
         inrc2.addGroup(skill);
+
+        // A shift requiring a skill can only be covered by a nurse with that skill
+        inrc2.addRule(implies(inGroup(timeSlot, skill), inGroup(nurseSlot, skill)));
     }
 
     // SHIFT TYPES
@@ -172,10 +175,10 @@ int main() {
                 const int min = v.second.get<int>(wdr + ".Minimum");
                 const int opt = v.second.get<int>(wdr + ".Optimal");
 
-                if(min != 0) {
+                if(std::max(min, opt) != 0) {
 
-                    // Create min assignments
-                    for(int j = 0; j < min + opt; j++){
+                    // Create min assignments, plus optional ones up to the optimal coverage
+                    for(int j = 0; j < std::max(min, opt); j++){
 
                         const std::string name = "w"+std::to_string(weekCounter)+"d"+std::to_string(dayCounter) + shiftType + skill + std::to_string(j);
                         auto &asgn = inrc2.newAssignment(name);
@@ -190,8 +193,11 @@ int main() {
 
                         asgn.setVariable(nurseSlot, nurseType, false);
 
-                        if(j >= min)
+                        // every missing nurse below the optimal coverage costs 30 (INRC2 weight)
+                        if(j >= min) {
                             asgn.setOptional(true);
+                            asgn.setWeight(30);
+                        }
                         else
                             asgn.setOptional(false);
                     }
@@ -217,10 +223,19 @@ int main() {
     //problemfile.open("/home/hal/Documents/testproblem.smt2");
     //inrc2.print(problemfile);
 
-    TranslatorZ3<std::string> trans (inrc2);
+    // shifts are fixed, so the skill rules reduce to per-slot nurse domains
+    OptionsZ3<std::string> options;
+    options.minimalEncoding = true;
+
+    TranslatorZ3<std::string> trans (inrc2, options);
     //trans.solve();
 
-    //Model model = translator.getModel();
+    // answer within the competition's time limit with the best roster found so far
+    TranslatorZ3<std::string>::Budget budget;
+    budget.time = std::chrono::seconds(60);
+    Model<std::string> model = trans.optimize(budget, [](const Model<std::string> &incumbent) {
+        std::cout << "penalty " << incumbent.getPenalty() << std::endl;
+    });
 
     // Generate solution files
     //std::ofstream solfile;
@@ -0,0 +1,671 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_BOOLEANGROUNDING_H
+#define OMTSCHED_BOOLEANGROUNDING_H
+
+#include "../Problem.h"
+#include "../Model.h"
+#include "../conditions/BasicConditions.h"
+#include "../conditions/BooleanConditions.h"
+#include "../conditions/OrderedConditions.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * Grounds a problem into propositional logic, the common part of the exporters for SAT and MIP solvers.
+     * Every (assignment, slot, component) is a Boolean variable, each active slot holds exactly one
+     * of its components and optional assignments have an activation variable, as in the one-hot
+     * encoding of the Z3 translator. Nested conditions are Tseitin encoded and equal subformulas share
+     * one variable. The constraints are handed to the exporter one at a time as clauses and
+     * at-most-one constraints, so it can write them out instead of keeping them.
+     */
+    template<typename ID>
+    class BooleanGrounding {
+    public:
+        virtual ~BooleanGrounding() = default;
+
+        /**
+         * @return the variable that is true iff the slot holds the component
+         */
+        int getVariable(const ID &assignment, const ID &slot, const ID &component) const;
+
+        /**
+         * @return the activation variable of an optional assignment
+         */
+        int getActivation(const ID &assignment) const;
+
+        size_t getVariableCount() const;
+
+        /**
+         * Reads back a solution of the grounded formula
+         * @param literals the true (positive) and false (negative) variables, e.g. the v lines of a solver
+         * @throws std::runtime_error if the solution leaves a slot of an active assignment empty
+         */
+        Model<ID> getModel(const std::vector<int> &literals) const;
+
+    protected:
+        using Lit = int;
+
+        explicit BooleanGrounding(const Problem<ID> &problem);
+
+        /**
+         * Grounds the problem from scratch: creates the variables, calls beginConstraints
+         * and then emitClause and emitAtMostOne for every constraint
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the grounding does not support
+         */
+        void ground();
+
+        /**
+         * Called once all variables of slots, activations and soft rules and all penalties exist
+         */
+        virtual void beginConstraints();
+
+        /**
+         * A hard clause, free of constants, duplicates and complementary literals
+         */
+        virtual void emitClause(const std::vector<Lit> &clause) = 0;
+
+        /**
+         * At most one of two or more literals holds if guard is true (or 0).
+         * Clauses by default, pairwise for a few literals and as a sequential counter for more
+         */
+        virtual void emitAtMostOne(const std::vector<Lit> &literals, const Lit &guard);
+
+        Lit newVariable();
+
+        // the clause holds if guard is true, constant literals are folded
+        void addClause(std::vector<Lit> clause, const Lit &guard = 0);
+        void atMostOne(std::vector<Lit> literals, const Lit &guard);
+
+        const Problem<ID> &problem;
+
+        int variables = 0;
+        // variable 1, always true
+        Lit truth = 0;
+
+        // unit soft clauses: the literal should hold, otherwise the weight is paid
+        std::vector<std::pair<Lit, int>> softClauses;
+
+        // one variable per component of the slot's type, in the order of Problem::getComponents
+        std::map<std::pair<ID, ID>, std::vector<Lit>> slots;
+        std::map<ID, Lit> activations;
+        // the literal of each weighted soft rule by handle, true iff the rule is kept
+        std::map<size_t, Lit> softRules;
+
+    private:
+
+        void setupVariables();
+        void setupDomains();
+        void setupRules();
+
+        Lit mkAnd(std::vector<Lit> literals);
+        Lit mkOr(std::vector<Lit> literals);
+        Lit mkXor(const Lit &first, const Lit &second);
+
+        // adds the condition as clauses that hold if guard is true
+        void require(const std::shared_ptr<Condition<ID>> &condition, const Lit &guard);
+
+        // a literal equivalent to the condition
+        Lit encode(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> *asgn = nullptr);
+
+        Lit isActive(const Assignment<ID> &asgn) const;
+        Lit isComponent(const Assignment<ID> &asgn, const ID &slot, const ID &component) const;
+        Lit isInGroup(const Assignment<ID> &asgn, const ID &slot, const ID &group);
+
+        // an active assignment that fulfills one of the conditions, for Blocked and Greater
+        Lit holds(const Assignment<ID> &asgn, const std::vector<std::shared_ptr<Condition<ID>>> &conditions);
+
+        // the triples of Blocked and the pairs of Greater as clauses
+        std::vector<std::vector<Lit>> getOrderClauses(const std::shared_ptr<Condition<ID>> &condition);
+
+        // per component, the assignments that hold it while active, for Distinct
+        std::map<ID, std::vector<Lit>> getHolders(const ID &slot);
+
+        // pairs and triples of assignments ordered by the components of the named slot
+        std::vector<const Assignment<ID> *> getOrder(const ID &namedSlot) const;
+
+        std::map<ID, size_t> ordinals;
+
+        // Tseitin variables of AND (tag 0) and XOR (tag 1) gates by tag and sorted inputs
+        std::map<std::vector<Lit>, Lit> gates;
+
+    };
+
+    template<typename ID>
+    BooleanGrounding<ID>::BooleanGrounding(const Problem<ID> &problem) : problem{problem} {}
+
+    template<typename ID>
+    void BooleanGrounding<ID>::ground() {
+
+        variables = 0;
+        softClauses.clear();
+        slots.clear();
+        activations.clear();
+        softRules.clear();
+        ordinals.clear();
+        gates.clear();
+
+        truth = newVariable();
+        setupVariables();
+
+        beginConstraints();
+
+        emitClause({truth});
+        setupDomains();
+        setupRules();
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::beginConstraints() {}
+
+    template<typename ID>
+    void BooleanGrounding<ID>::setupVariables() {
+
+        for(const ID &type : problem.getComponentTypes()) {
+            size_t ordinal = 0;
+            for(const auto &component : problem.getComponents(type))
+                ordinals.emplace(component->getID(), ordinal++);
+        }
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                std::vector<Lit> &literals = slots[std::make_pair(aid, sid)];
+                for(size_t i = 0; i < problem.getComponents(slot.type).size(); i++)
+                    literals.push_back(newVariable());
+            }
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            if(asgn.isOptional())
+                activations.emplace(aid, newVariable());
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            if(asgn.isOptional() && asgn.getWeight() != 0) {
+                if(asgn.getWeight() < 0)
+                    throw std::invalid_argument("weights of optional assignments cannot be negative");
+                softClauses.emplace_back(activations.at(aid), asgn.getWeight());
+            }
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+        for(size_t handle = 0; handle < rules.size(); handle++) {
+
+            const Rule<ID> &rule = rules.at(handle);
+
+            // violating a soft rule without weight costs nothing, so it needs no literal
+            if(!rule.isOptional() || rule.getWeight() == 0)
+                continue;
+
+            if(rule.getWeight() < 0)
+                throw std::invalid_argument("weights of soft rules cannot be negative");
+
+            // the rule holds if its literal does, as the guards in the Z3 translator
+            const Lit guard = newVariable();
+            softRules.emplace(handle, guard);
+            softClauses.emplace_back(guard, rule.getWeight());
+        }
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::setupDomains() {
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                const std::vector<Lit> &literals = slots.at(std::make_pair(aid, sid));
+
+                // at least one component while active, fixed slots always hold theirs
+                addClause(literals, slot.fixed ? 0 : isActive(asgn));
+                atMostOne(literals, 0);
+
+                if(slot.fixed)
+                    addClause({isComponent(asgn, sid, slot.component)});
+            }
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::setupRules() {
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+
+        for(size_t handle = 0; handle < rules.size(); handle++) {
+
+            const Rule<ID> &rule = rules.at(handle);
+
+            if(!rule.isOptional())
+                require(rule.getTopCondition(), 0);
+            else if(softRules.count(handle))
+                require(rule.getTopCondition(), softRules.at(handle));
+        }
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::newVariable() {
+        return ++variables;
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::addClause(std::vector<Lit> clause, const Lit &guard) {
+
+        if(guard != 0)
+            clause.push_back(-guard);
+
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+
+        // satisfied by a constant or by a literal and its negation
+        for(const Lit &literal : clause)
+            if(literal == truth || std::binary_search(clause.begin(), clause.end(), -literal))
+                return;
+
+        // the empty clause stays -truth
+        if(clause.size() > 1)
+            clause.erase(std::remove(clause.begin(), clause.end(), -truth), clause.end());
+
+        emitClause(clause);
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::atMostOne(std::vector<Lit> literals, const Lit &guard) {
+
+        // false literals do not count, a false guard switches the constraint off
+        literals.erase(std::remove(literals.begin(), literals.end(), -truth), literals.end());
+
+        if(literals.size() > 1 && guard != -truth)
+            emitAtMostOne(literals, guard == truth ? 0 : guard);
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::emitAtMostOne(const std::vector<Lit> &literals, const Lit &guard) {
+
+        const size_t n = literals.size();
+
+        if(n <= 5) {
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = i + 1; j < n; j++)
+                    addClause({-literals.at(i), -literals.at(j)}, guard);
+            return;
+        }
+
+        // sequential counter: s[i] holds if one of the first i + 1 literals does
+        std::vector<Lit> counter;
+        for(size_t i = 0; i + 1 < n; i++)
+            counter.push_back(newVariable());
+
+        addClause({-literals.at(0), counter.at(0)}, guard);
+        for(size_t i = 1; i + 1 < n; i++) {
+            addClause({-literals.at(i), counter.at(i)}, guard);
+            addClause({-counter.at(i - 1), counter.at(i)}, guard);
+            addClause({-literals.at(i), -counter.at(i - 1)}, guard);
+        }
+        addClause({-literals.at(n - 1), -counter.at(n - 2)}, guard);
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::mkAnd(std::vector<Lit> literals) {
+
+        std::sort(literals.begin(), literals.end());
+        literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+        literals.erase(std::remove(literals.begin(), literals.end(), truth), literals.end());
+
+        for(const Lit &literal : literals)
+            if(literal == -truth || std::binary_search(literals.begin(), literals.end(), -literal))
+                return -truth;
+
+        if(literals.empty())
+            return truth;
+        if(literals.size() == 1)
+            return literals.front();
+
+        std::vector<Lit> key {0};
+        key.insert(key.end(), literals.begin(), literals.end());
+
+        auto it = gates.find(key);
+        if(it != gates.end())
+            return it->second;
+
+        const Lit gate = newVariable();
+        gates.emplace(std::move(key), gate);
+
+        std::vector<Lit> definition {gate};
+        for(const Lit &literal : literals) {
+            addClause({-gate, literal});
+            definition.push_back(-literal);
+        }
+        addClause(definition);
+
+        return gate;
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::mkOr(std::vector<Lit> literals) {
+
+        for(Lit &literal : literals)
+            literal = -literal;
+
+        return -mkAnd(std::move(literals));
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::mkXor(const Lit &first, const Lit &second) {
+
+        if(first == truth || first == -truth)
+            return first == truth ? -second : second;
+        if(second == truth || second == -truth)
+            return second == truth ? -first : first;
+        if(first == second)
+            return -truth;
+        if(first == -second)
+            return truth;
+
+        std::vector<Lit> key {1, std::min(first, second), std::max(first, second)};
+
+        auto it = gates.find(key);
+        if(it != gates.end())
+            return it->second;
+
+        const Lit gate = newVariable();
+        gates.emplace(std::move(key), gate);
+
+        addClause({-gate, first, second});
+        addClause({-gate, -first, -second});
+        addClause({gate, -first, second});
+        addClause({gate, first, -second});
+
+        return gate;
+    }
+
+    template<typename ID>
+    void BooleanGrounding<ID>::require(const std::shared_ptr<Condition<ID>> &condition, const Lit &guard) {
+
+        // conditions that are conjunctions anyway become clauses without Tseitin variables
+        switch(condition->getType()) {
+
+            case CONDITION_TYPE::AND:
+                for(const auto &subcondition : condition->subconditions)
+                    require(subcondition, guard);
+                return;
+
+            case CONDITION_TYPE::COMPONENT_IS:
+            case CONDITION_TYPE::IN_GROUP: {
+                const bool componentIs = condition->getType() == CONDITION_TYPE::COMPONENT_IS;
+                const ID &slot = componentIs ? std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->componentSlot
+                                             : std::dynamic_pointer_cast<InGroup<ID>>(condition)->slot;
+
+                for(const auto &[aid, asgn] : problem.getAssignments())
+                    if(asgn.getComponentSlots().count(slot))
+                        addClause({-isActive(asgn), encode(condition, &asgn)}, guard);
+                return;
+            }
+
+            case CONDITION_TYPE::IMPLIES:
+                for(const auto &[aid, asgn] : problem.getAssignments())
+                    addClause({-isActive(asgn), -encode(condition->subconditions.at(0), &asgn),
+                               encode(condition->subconditions.at(1), &asgn)}, guard);
+                return;
+
+            case CONDITION_TYPE::DISTINCT:
+                for(const auto &[component, holders] : getHolders(std::dynamic_pointer_cast<Distinct<ID>>(condition)->componentSlot))
+                    atMostOne(holders, guard);
+                return;
+
+            case CONDITION_TYPE::BLOCKED:
+            case CONDITION_TYPE::GREATER:
+                for(std::vector<Lit> &clause : getOrderClauses(condition))
+                    addClause(std::move(clause), guard);
+                return;
+
+            default:
+                addClause({encode(condition)}, guard);
+        }
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::encode(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> *asgn) {
+
+        std::vector<Lit> literals;
+
+        switch(condition->getType()) {
+
+            case CONDITION_TYPE::NOT:
+                return -encode(condition->subconditions.at(0), asgn);
+
+            case CONDITION_TYPE::AND:
+            case CONDITION_TYPE::OR:
+                for(const auto &subcondition : condition->subconditions)
+                    literals.push_back(encode(subcondition, asgn));
+                return condition->getType() == CONDITION_TYPE::AND ? mkAnd(literals) : mkOr(literals);
+
+            case CONDITION_TYPE::XOR:
+            case CONDITION_TYPE::IFF: {
+                const Lit different = mkXor(encode(condition->subconditions.at(0), asgn),
+                                            encode(condition->subconditions.at(1), asgn));
+                return condition->getType() == CONDITION_TYPE::XOR ? different : -different;
+            }
+
+            // instantiated for every assignment, also below the top level
+            case CONDITION_TYPE::IMPLIES:
+                for(const auto &[aid, a] : problem.getAssignments())
+                    literals.push_back(mkOr({-isActive(a), -encode(condition->subconditions.at(0), &a),
+                                             encode(condition->subconditions.at(1), &a)}));
+                return mkAnd(literals);
+
+            case CONDITION_TYPE::COMPONENT_IS:
+            case CONDITION_TYPE::IN_GROUP: {
+                const bool componentIs = condition->getType() == CONDITION_TYPE::COMPONENT_IS;
+                const auto instance = [&](const Assignment<ID> &a) {
+                    if(componentIs) {
+                        const auto c = std::dynamic_pointer_cast<ComponentIs<ID>>(condition);
+                        return isComponent(a, c->componentSlot, c->component);
+                    }
+                    const auto c = std::dynamic_pointer_cast<InGroup<ID>>(condition);
+                    return isInGroup(a, c->slot, c->group);
+                };
+
+                if(asgn)
+                    return instance(*asgn);
+
+                const ID &slot = componentIs ? std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->componentSlot
+                                             : std::dynamic_pointer_cast<InGroup<ID>>(condition)->slot;
+
+                for(const auto &[aid, a] : problem.getAssignments())
+                    if(a.getComponentSlots().count(slot))
+                        literals.push_back(mkOr({-isActive(a), instance(a)}));
+                return mkAnd(literals);
+            }
+
+            // compares combinations of assignments, rules only instantiate single ones so far
+            case CONDITION_TYPE::SAME_COMPONENT:
+                return truth;
+
+            // below the top level the pairs are listed, no counter can be switched off
+            case CONDITION_TYPE::DISTINCT:
+                for(const auto &[component, holders] : getHolders(std::dynamic_pointer_cast<Distinct<ID>>(condition)->componentSlot))
+                    for(size_t i = 0; i < holders.size(); i++)
+                        for(size_t j = i + 1; j < holders.size(); j++)
+                            literals.push_back(mkOr({-holders.at(i), -holders.at(j)}));
+                return mkAnd(literals);
+
+            case CONDITION_TYPE::BLOCKED:
+            case CONDITION_TYPE::GREATER:
+                for(const std::vector<Lit> &clause : getOrderClauses(condition))
+                    literals.push_back(mkOr(clause));
+                return mkAnd(literals);
+
+            default:
+                throw std::invalid_argument("condition type not supported by the Boolean grounding");
+        }
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::isActive(const Assignment<ID> &asgn) const {
+
+        if(!asgn.isOptional())
+            return truth;
+
+        return activations.at(asgn.getID());
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::isComponent(const Assignment<ID> &asgn, const ID &slot, const ID &component) const {
+
+        const auto &type = problem.getComponents(asgn.getSlot(slot).type);
+        const auto it = ordinals.find(component);
+
+        // a component of another type is never held
+        if(it == ordinals.end() || it->second >= type.size() || type.at(it->second)->getID() != component)
+            return -truth;
+
+        return slots.at(std::make_pair(asgn.getID(), slot)).at(it->second);
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::isInGroup(const Assignment<ID> &asgn, const ID &slot, const ID &group) {
+
+        const std::vector<Lit> &literals = slots.at(std::make_pair(asgn.getID(), slot));
+        const auto &components = problem.getComponents(asgn.getSlot(slot).type);
+
+        std::vector<Lit> members;
+        for(size_t i = 0; i < components.size(); i++)
+            if(components.at(i)->inGroup(group))
+                members.push_back(literals.at(i));
+
+        return mkOr(members);
+    }
+
+    template<typename ID>
+    typename BooleanGrounding<ID>::Lit BooleanGrounding<ID>::holds(const Assignment<ID> &asgn,
+                                                               const std::vector<std::shared_ptr<Condition<ID>>> &conditions) {
+
+        std::vector<Lit> fulfilled;
+        for(const auto &condition : conditions)
+            fulfilled.push_back(encode(condition, &asgn));
+
+        return mkAnd({isActive(asgn), mkOr(fulfilled)});
+    }
+
+    template<typename ID>
+    std::vector<std::vector<typename BooleanGrounding<ID>::Lit>> BooleanGrounding<ID>::getOrderClauses(const std::shared_ptr<Condition<ID>> &condition) {
+
+        std::vector<std::vector<Lit>> result;
+
+        if(condition->getType() == CONDITION_TYPE::BLOCKED) {
+
+            const std::vector<const Assignment<ID> *> order = getOrder(std::dynamic_pointer_cast<Blocked<ID>>(condition)->getNamedSlot());
+
+            std::vector<Lit> fulfilled;
+            for(const Assignment<ID> *asgn : order)
+                fulfilled.push_back(holds(*asgn, condition->subconditions));
+
+            // if two assignments fulfill the condition, so do all in between
+            for(size_t first = 0; first + 2 < order.size(); first++)
+                for(size_t last = first + 2; last < order.size(); last++)
+                    for(size_t between = first + 1; between < last; between++)
+                        result.push_back({-fulfilled.at(first), -fulfilled.at(last), fulfilled.at(between)});
+
+            return result;
+        }
+
+        const ID namedSlot = std::dynamic_pointer_cast<Greater<ID>>(condition)->getNamedSlot();
+
+        // no active assignment fulfilling the first condition comes before one fulfilling the second
+        for(const auto &[id1, asgn1] : problem.getAssignments())
+            for(const auto &[id2, asgn2] : problem.getAssignments())
+                if(asgn1.getSlot(namedSlot).component < asgn2.getSlot(namedSlot).component)
+                    result.push_back({-holds(asgn1, {condition->subconditions.at(0)}),
+                                      -holds(asgn2, {condition->subconditions.at(1)})});
+
+        return result;
+    }
+
+    template<typename ID>
+    std::map<ID, std::vector<typename BooleanGrounding<ID>::Lit>> BooleanGrounding<ID>::getHolders(const ID &slot) {
+
+        std::map<ID, std::vector<Lit>> holders;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            if(!asgn.getComponentSlots().count(slot))
+                continue;
+
+            const auto &components = problem.getComponents(asgn.getSlot(slot).type);
+            for(const auto &component : components)
+                holders[component->getID()].push_back(mkAnd({isActive(asgn), isComponent(asgn, slot, component->getID())}));
+        }
+
+        return holders;
+    }
+
+    template<typename ID>
+    std::vector<const Assignment<ID> *> BooleanGrounding<ID>::getOrder(const ID &namedSlot) const {
+
+        // by the component of the named slot, ties by ID
+        std::vector<std::pair<ID, const Assignment<ID> *>> order;
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            order.emplace_back(asgn.getSlot(namedSlot).component, &asgn);
+        std::stable_sort(order.begin(), order.end(),
+                         [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+        std::vector<const Assignment<ID> *> assignments;
+        for(const auto &[component, asgn] : order)
+            assignments.push_back(asgn);
+
+        return assignments;
+    }
+
+    template<typename ID>
+    int BooleanGrounding<ID>::getVariable(const ID &assignment, const ID &slot, const ID &component) const {
+        return slots.at(std::make_pair(assignment, slot)).at(ordinals.at(component));
+    }
+
+    template<typename ID>
+    int BooleanGrounding<ID>::getActivation(const ID &assignment) const {
+        return activations.at(assignment);
+    }
+
+    template<typename ID>
+    size_t BooleanGrounding<ID>::getVariableCount() const {
+        return (size_t) variables;
+    }
+
+    template<typename ID>
+    Model<ID> BooleanGrounding<ID>::getModel(const std::vector<int> &literals) const {
+
+        std::vector<bool> values(variables + 1, false);
+        for(const int &literal : literals)
+            if(literal > 0 && literal <= variables)
+                values.at(literal) = true;
+
+        Model<ID> model;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            if(asgn.isOptional() && !values.at(activations.at(aid))) {
+                model.addUnfilled(aid, asgn.getWeight());
+                continue;
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                const std::vector<Lit> &candidates = slots.at(std::make_pair(aid, sid));
+                const auto it = std::find_if(candidates.begin(), candidates.end(), [&](const Lit &l) { return values.at(l); });
+                if(it == candidates.end())
+                    throw std::runtime_error("the solution leaves a slot empty");
+                model.setComponent(aid, sid, problem.getComponents(slot.type).at(it - candidates.begin())->getID());
+            }
+        }
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+        for(const auto &[handle, literal] : softRules)
+            if(!values.at(literal))
+                model.addViolation(handle, rules.at(handle).getWeight());
+
+        return model;
+    }
+
+}
+
+#endif //OMTSCHED_BOOLEANGROUNDING_H
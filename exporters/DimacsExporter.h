@@ -0,0 +1,147 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_DIMACSEXPORTER_H
+#define OMTSCHED_DIMACSEXPORTER_H
+
+#include "BooleanGrounding.h"
+#include <stdexcept>
+
+namespace omtsched {
+
+    /*
+     * Writes the Boolean grounding of a problem for SAT and MaxSAT solvers.
+     * At-most-one constraints (slot domains, Distinct) use sequential counters.
+     * Without weighted soft rules or optional assignments the result is written as DIMACS CNF,
+     * otherwise as WCNF where violating a soft rule or leaving an assignment unfilled costs its weight.
+     */
+    template<typename ID>
+    class DimacsExporter : public BooleanGrounding<ID> {
+    public:
+        /**
+         * Grounds the problem
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the grounding does not support
+         */
+        explicit DimacsExporter(const Problem<ID> &problem);
+
+        /**
+         * @param names list the variables of slots, activations and rules as comments
+         */
+        void print(std::ostream &ostr, const bool &names = false) const;
+
+        /**
+         * @param compress gzip the file, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the file cannot be opened or written
+         */
+        void print(const std::string &path, const bool &compress = false, const bool &names = false) const;
+
+        void print(SmtWriter &ostr, const bool &names = false) const;
+
+        /**
+         * @return true if the problem has penalties and is written as WCNF
+         */
+        bool isWeighted() const;
+
+        size_t getClauseCount() const;
+
+    private:
+        using Lit = typename BooleanGrounding<ID>::Lit;
+
+        void emitClause(const std::vector<Lit> &clause) override;
+
+        // hard clauses, each terminated by 0
+        std::vector<Lit> clauses;
+        size_t clauseCount = 0;
+
+    };
+
+    template<typename ID>
+    DimacsExporter<ID>::DimacsExporter(const Problem<ID> &problem) : BooleanGrounding<ID>{problem} {
+        this->ground();
+    }
+
+    template<typename ID>
+    void DimacsExporter<ID>::emitClause(const std::vector<Lit> &clause) {
+
+        clauses.insert(clauses.end(), clause.begin(), clause.end());
+        clauses.push_back(0);
+        clauseCount++;
+    }
+
+    template<typename ID>
+    void DimacsExporter<ID>::print(std::ostream &ostr, const bool &names) const {
+
+        SmtWriter writer {ostr};
+        print(writer, names);
+    }
+
+    template<typename ID>
+    void DimacsExporter<ID>::print(const std::string &path, const bool &compress, const bool &names) const {
+
+        SmtWriter writer {path, compress};
+        print(writer, names);
+        writer.flush();
+        if(!writer.good())
+            throw std::runtime_error("could not write " + path);
+    }
+
+    template<typename ID>
+    void DimacsExporter<ID>::print(SmtWriter &ostr, const bool &names) const {
+
+        if(names) {
+            for(const auto &[key, literals] : this->slots) {
+                const auto &components = this->problem.getComponents(this->problem.getAssignment(key.first).getSlot(key.second).type);
+                for(size_t i = 0; i < literals.size(); i++) {
+                    ostr << "c " << literals.at(i) << ' ';
+                    printSlot(ostr, key.first, key.second) << ' ';
+                    ostr.symbol("c", components.at(i)->getID()) << '\n';
+                }
+            }
+            for(const auto &[aid, literal] : this->activations) {
+                ostr << "c " << literal << ' ';
+                ostr.symbol("act", aid) << '\n';
+            }
+            for(const auto &[handle, literal] : this->softRules) {
+                ostr << "c " << literal << ' ';
+                ostr.symbol("r", handle) << '\n';
+            }
+        }
+
+        // hard clauses have the weight top, more than all soft clauses together
+        long top = 1;
+        for(const auto &[literal, weight] : this->softClauses)
+            top += weight;
+
+        if(isWeighted())
+            ostr << "p wcnf " << this->variables << ' ' << clauseCount + this->softClauses.size() << ' ' << top << '\n';
+        else
+            ostr << "p cnf " << this->variables << ' ' << clauseCount << '\n';
+
+        bool start = true;
+        for(const Lit &literal : clauses) {
+
+            if(start && isWeighted())
+                ostr << top << ' ';
+
+            ostr << literal << (literal == 0 ? '\n' : ' ');
+            start = literal == 0;
+        }
+
+        for(const auto &[literal, weight] : this->softClauses)
+            ostr << weight << ' ' << literal << " 0\n";
+    }
+
+    template<typename ID>
+    bool DimacsExporter<ID>::isWeighted() const {
+        return !this->softClauses.empty();
+    }
+
+    template<typename ID>
+    size_t DimacsExporter<ID>::getClauseCount() const {
+        return clauseCount + this->softClauses.size();
+    }
+
+}
+
+#endif //OMTSCHED_DIMACSEXPORTER_H
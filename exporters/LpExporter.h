@@ -0,0 +1,326 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_LPEXPORTER_H
+#define OMTSCHED_LPEXPORTER_H
+
+#include "BooleanGrounding.h"
+#include <cstdlib>
+#include <stdexcept>
+
+namespace omtsched {
+
+    /*
+     * File formats of LpExporter.
+     * LP:  CPLEX LP format, the rows are written while the problem is grounded
+     * MPS: free MPS, lists the matrix by column, so it is kept until all rows are known
+     */
+    enum class MIP_FORMAT {
+        LP, MPS
+    };
+
+    /*
+     * Writes a problem as a 0-1 integer program for MIP solvers.
+     * The variables x[assignment][slot][component], activations and Tseitin variables
+     * are those of the Boolean grounding, all binary and named x1, x2, ... by their number.
+     * A clause becomes the row sum(literals) >= 1 with 1 - x for a negated x, at-most-one constraints
+     * (slot domains, Distinct) become sum(literals) <= 1 and a guard g adds (n - 1) * (1 - g) to the bound.
+     * Every penalty has a variable that is 1 iff it is paid, the objective minimizes their weighted sum,
+     * so its optimum equals the penalty of TranslatorZ3. getModel reads back the variables that are 1.
+     */
+    template<typename ID>
+    class LpExporter : public BooleanGrounding<ID> {
+    public:
+        explicit LpExporter(const Problem<ID> &problem);
+
+        /**
+         * Grounds the problem and writes it, the variables refer to the last call
+         * @param names list the variables of slots, activations and rules as comments
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the grounding does not support
+         */
+        void print(std::ostream &ostr, const MIP_FORMAT &format = MIP_FORMAT::LP, const bool &names = false);
+
+        /**
+         * @param compress gzip the file, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the file cannot be opened or written
+         */
+        void print(const std::string &path, const bool &compress = false, const MIP_FORMAT &format = MIP_FORMAT::LP,
+                   const bool &names = false);
+
+        void print(SmtWriter &ostr, const MIP_FORMAT &format = MIP_FORMAT::LP, const bool &names = false);
+
+        /**
+         * @return number of constraints written by the last print
+         */
+        size_t getRowCount() const;
+
+    private:
+        using Lit = typename BooleanGrounding<ID>::Lit;
+
+        // sum(coefficient * variable) sense bound, sense is 'G', 'L' or 'E'
+        struct Row {
+            std::map<Lit, long> terms;
+            char sense;
+            long bound;
+        };
+
+        void beginConstraints() override;
+        void emitClause(const std::vector<Lit> &clause) override;
+        void emitAtMostOne(const std::vector<Lit> &literals, const Lit &guard) override;
+
+        // adds coefficient * literal, a negated variable as 1 - x with the constant moved to the bound
+        static void addTerm(Row &row, const Lit &literal, const long &coefficient);
+
+        void emitRow(const Row &row);
+
+        void printNames(const char *comment);
+        void printTerms(const std::map<Lit, long> &terms);
+        void printMps();
+
+        SmtWriter *ostr = nullptr;
+        MIP_FORMAT format = MIP_FORMAT::LP;
+        bool names = false;
+
+        size_t rows = 0;
+        std::map<Lit, long> objective;
+
+        // MPS only: per column the rows and coefficients, per row its sense and bound
+        std::vector<std::vector<std::pair<size_t, long>>> columns;
+        std::vector<std::pair<char, long>> bounds;
+
+    };
+
+    template<typename ID>
+    LpExporter<ID>::LpExporter(const Problem<ID> &problem) : BooleanGrounding<ID>{problem} {}
+
+    template<typename ID>
+    void LpExporter<ID>::print(std::ostream &ostr, const MIP_FORMAT &format, const bool &names) {
+
+        SmtWriter writer {ostr};
+        print(writer, format, names);
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::print(const std::string &path, const bool &compress, const MIP_FORMAT &format, const bool &names) {
+
+        SmtWriter writer {path, compress};
+        print(writer, format, names);
+        writer.flush();
+        if(!writer.good())
+            throw std::runtime_error("could not write " + path);
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::print(SmtWriter &ostr, const MIP_FORMAT &format, const bool &names) {
+
+        this->ostr = &ostr;
+        this->format = format;
+        this->names = names;
+        rows = 0;
+        objective.clear();
+        columns.clear();
+        bounds.clear();
+
+        this->ground();
+
+        if(format == MIP_FORMAT::MPS)
+            printMps();
+        else {
+            ostr << "Binaries\n";
+            for(Lit x = 1; x <= this->variables; x++) {
+                ostr << " x" << x;
+                if(x % 10 == 0 || x == this->variables)
+                    ostr << '\n';
+            }
+            ostr << "End\n";
+        }
+
+        columns.clear();
+        bounds.clear();
+        this->ostr = nullptr;
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::beginConstraints() {
+
+        // a negated literal is paid when its variable is 1, otherwise a new variable takes the penalty
+        std::vector<Row> penalties;
+        for(const auto &[literal, weight] : this->softClauses) {
+
+            if(literal < 0) {
+                objective[-literal] += weight;
+                continue;
+            }
+
+            const Lit paid = this->newVariable();
+            objective[paid] += weight;
+            penalties.push_back(Row{{{literal, 1}, {paid, 1}}, 'E', 1});
+        }
+
+        if(format == MIP_FORMAT::LP) {
+
+            if(names)
+                printNames("\\");
+
+            *ostr << "Minimize\n obj:";
+            printTerms(objective);
+            *ostr << "\nSubject To\n";
+        }
+
+        for(const Row &row : penalties)
+            emitRow(row);
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::emitClause(const std::vector<Lit> &clause) {
+
+        Row row {{}, 'G', 1};
+        for(const Lit &literal : clause)
+            addTerm(row, literal, 1);
+
+        emitRow(row);
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::emitAtMostOne(const std::vector<Lit> &literals, const Lit &guard) {
+
+        Row row {{}, 'L', 1};
+        for(const Lit &literal : literals)
+            addTerm(row, literal, 1);
+
+        // sum + (n - 1) * g <= n: at most one if g is 1, no limit if it is 0
+        if(guard != 0) {
+            const long relax = (long) literals.size() - 1;
+            addTerm(row, guard, relax);
+            row.bound += relax;
+        }
+
+        emitRow(row);
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::addTerm(Row &row, const Lit &literal, const long &coefficient) {
+
+        if(literal > 0)
+            row.terms[literal] += coefficient;
+        else {
+            row.terms[-literal] -= coefficient;
+            row.bound -= coefficient;
+        }
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::emitRow(const Row &row) {
+
+        rows++;
+
+        if(format == MIP_FORMAT::MPS) {
+
+            columns.resize(this->variables + 1);
+            for(const auto &[x, coefficient] : row.terms)
+                if(coefficient != 0)
+                    columns.at(x).emplace_back(rows, coefficient);
+
+            bounds.emplace_back(row.sense, row.bound);
+            return;
+        }
+
+        *ostr << " c" << rows << ':';
+        printTerms(row.terms);
+        *ostr << (row.sense == 'G' ? " >= " : row.sense == 'L' ? " <= " : " = ") << row.bound << '\n';
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::printNames(const char *comment) {
+
+        SmtWriter &ostr = *this->ostr;
+
+        for(const auto &[key, literals] : this->slots) {
+            const auto &components = this->problem.getComponents(this->problem.getAssignment(key.first).getSlot(key.second).type);
+            for(size_t i = 0; i < literals.size(); i++) {
+                ostr << comment << " x" << literals.at(i) << ' ';
+                printSlot(ostr, key.first, key.second) << ' ';
+                ostr.symbol("c", components.at(i)->getID()) << '\n';
+            }
+        }
+        for(const auto &[aid, literal] : this->activations) {
+            ostr << comment << " x" << literal << ' ';
+            ostr.symbol("act", aid) << '\n';
+        }
+        for(const auto &[handle, literal] : this->softRules) {
+            ostr << comment << " x" << literal << ' ';
+            ostr.symbol("r", handle) << '\n';
+        }
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::printTerms(const std::map<Lit, long> &terms) {
+
+        // lines of LP files are limited, long rows continue on the next line
+        size_t written = 0;
+        for(const auto &[x, coefficient] : terms) {
+
+            if(coefficient == 0)
+                continue;
+
+            if(written > 0 && written % 10 == 0)
+                *ostr << "\n   ";
+
+            *ostr << (coefficient < 0 ? " - " : " + ") << std::abs(coefficient) << " x" << x;
+            written++;
+        }
+
+        if(written == 0)
+            *ostr << " 0 x1";
+    }
+
+    template<typename ID>
+    void LpExporter<ID>::printMps() {
+
+        SmtWriter &ostr = *this->ostr;
+
+        if(names)
+            printNames("*");
+
+        ostr << "NAME omtsched\nROWS\n N obj\n";
+        for(size_t row = 0; row < bounds.size(); row++)
+            ostr << ' ' << bounds.at(row).first << " c" << row + 1 << '\n';
+
+        columns.resize(this->variables + 1);
+
+        ostr << "COLUMNS\n    MARKER 'MARKER' 'INTORG'\n";
+        for(Lit x = 1; x <= this->variables; x++) {
+
+            const auto it = objective.find(x);
+            const bool inObjective = it != objective.end() && it->second != 0;
+
+            // every column is listed, also one that no row uses
+            if(inObjective || columns.at(x).empty())
+                ostr << "    x" << x << " obj " << (inObjective ? it->second : 0) << '\n';
+
+            for(const auto &[row, coefficient] : columns.at(x))
+                ostr << "    x" << x << " c" << row << ' ' << coefficient << '\n';
+        }
+        ostr << "    MARKER 'MARKER' 'INTEND'\n";
+
+        ostr << "RHS\n";
+        for(size_t row = 0; row < bounds.size(); row++)
+            if(bounds.at(row).second != 0)
+                ostr << "    rhs c" << row + 1 << ' ' << bounds.at(row).second << '\n';
+
+        ostr << "BOUNDS\n";
+        for(Lit x = 1; x <= this->variables; x++)
+            ostr << " BV bnd x" << x << '\n';
+
+        ostr << "ENDATA\n";
+    }
+
+    template<typename ID>
+    size_t LpExporter<ID>::getRowCount() const {
+        return rows;
+    }
+
+}
+
+#endif //OMTSCHED_LPEXPORTER_H
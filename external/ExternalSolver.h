@@ -0,0 +1,512 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_EXTERNALSOLVER_H
+#define OMTSCHED_EXTERNALSOLVER_H
+
+#include "../Translator.h"
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace omtsched {
+
+    /*
+     * Outcome of a run of an external solver.
+     * TIMEOUT and CANCELLED: the process was killed before it answered
+     * FAILED: the solver could not be started or its output could not be read, see getError
+     */
+    enum class SOLVER_ANSWER {
+        SAT, UNSAT, UNKNOWN, TIMEOUT, CANCELLED, FAILED
+    };
+
+    /*
+     * Solves a problem in a separate solver process, e.g. z3 -in, that reads SMT-LIB from stdin.
+     * Problem::print is streamed into the process followed by get-value for all slots, activations,
+     * components and soft rules, the answers are read back into a Model. A crash or a runaway
+     * instance only takes down the process, which is killed on timeout or cancel, and several
+     * solvers can run side by side. The solver needs assert-soft (or minimize, see the objective)
+     * if the problem has penalties. POSIX only.
+     */
+    template<typename ID>
+    class ExternalSolver : public omtsched::Translator<ID> {
+    public:
+        /**
+         * @param command program and arguments, the program is searched in PATH
+         * @param timeout the process is killed after this time, 0 for none
+         * @param objective how Problem::print states the penalties
+         */
+        ExternalSolver(const Problem<ID> &problem, std::vector<std::string> command = {"z3", "-in"},
+                       const std::chrono::milliseconds &timeout = std::chrono::milliseconds{0},
+                       const SMT_OBJECTIVE &objective = SMT_OBJECTIVE::ASSERT_SOFT);
+
+        void solve() override;
+
+        /**
+         * Runs the solver, the first answer is kept
+         */
+        SOLVER_ANSWER run();
+
+        Model<ID> getModel() override;
+
+        bool isSAT() override;
+
+        /**
+         * Kills the solver process, can be called from any thread, also before run
+         */
+        void cancel();
+
+        /**
+         * @return why the run failed or the errors the solver reported
+         */
+        const std::string &getError() const;
+
+    private:
+
+        // an ostream onto a file descriptor, SmtWriter already hands over large blocks
+        class PipeBuffer : public std::streambuf {
+        public:
+            explicit PipeBuffer(const int &fd) : fd{fd} {}
+
+        protected:
+            int_type overflow(int_type c) override;
+            std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+        private:
+            const int fd;
+        };
+
+        // an s-expression of the solver output, an atom if list is empty
+        struct Term {
+            std::string atom;
+            std::vector<Term> list;
+        };
+
+        // streams the problem and the queries into the process
+        void send(const int &fd) const;
+        // false if a value is no component of the slot's type, the value is added to the error
+        bool readModel(const Term &values);
+
+        static std::optional<Term> parse(const std::string &text, size_t &pos);
+        static std::string toString(const Term &term);
+
+        const std::vector<std::string> command;
+        const std::chrono::milliseconds timeout;
+        const SMT_OBJECTIVE objective;
+
+        // the terms of get-value in order: per assignment its activation and slots, the components, the soft rules
+        size_t queries = 0;
+        std::vector<std::pair<ID, ID>> components;
+        std::vector<size_t> softRules;
+
+        std::optional<SOLVER_ANSWER> result;
+        std::optional<Model<ID>> model;
+        std::string error;
+
+        // the running process, guarded for cancel
+        std::mutex mutex;
+        pid_t pid = -1;
+        bool cancelled = false;
+
+    };
+
+    template<typename ID>
+    ExternalSolver<ID>::ExternalSolver(const Problem<ID> &problem, std::vector<std::string> command,
+                                       const std::chrono::milliseconds &timeout, const SMT_OBJECTIVE &objective) :
+    Translator<ID>{problem}, command{std::move(command)}, timeout{timeout}, objective{objective} {
+
+        assert(!this->command.empty() && "the command needs at least the program");
+
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            queries += asgn.isOptional() + asgn.getComponentSlots().size();
+
+        for(const ID &type : problem.getComponentTypes())
+            for(const auto &component : problem.getComponents(type))
+                components.emplace_back(type, component->getID());
+
+        const std::vector<Rule<ID>> &rules = problem.getRules();
+        for(size_t handle = 0; handle < rules.size(); handle++)
+            if(rules.at(handle).isOptional() && rules.at(handle).getWeight() != 0)
+                softRules.push_back(handle);
+
+        queries += components.size() + softRules.size();
+    }
+
+    template<typename ID>
+    void ExternalSolver<ID>::solve() {
+
+        const SOLVER_ANSWER answer = run();
+
+        if(answer == SOLVER_ANSWER::UNSAT)
+            std::cout << "UNSAT" << std::endl;
+        else if(answer == SOLVER_ANSWER::SAT)
+            std::cout << "SAT" << std::endl;
+        else
+            std::cout << "UNKNOWN" << std::endl;
+    }
+
+    template<typename ID>
+    SOLVER_ANSWER ExternalSolver<ID>::run() {
+
+        if(result)
+            return *result;
+
+        int input[2], output[2];
+        if(pipe2(input, O_CLOEXEC) != 0 || pipe2(output, O_CLOEXEC) != 0) {
+            error = "could not create pipes";
+            return *(result = SOLVER_ANSWER::FAILED);
+        }
+
+        // the child only keeps its ends as stdin and stdout, dup2 clears close-on-exec
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+
+        // its own process group, so helpers it starts are killed with it
+        posix_spawnattr_t attributes;
+        posix_spawnattr_init(&attributes);
+        posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attributes, 0);
+
+        std::vector<char *> argv;
+        for(const std::string &argument : command)
+            argv.push_back(const_cast<char *>(argument.c_str()));
+        argv.push_back(nullptr);
+
+        pid_t child = -1;
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+
+            const int spawned = cancelled ? ECANCELED : posix_spawnp(&child, argv.front(), &actions, &attributes, argv.data(), environ);
+            posix_spawn_file_actions_destroy(&actions);
+            posix_spawnattr_destroy(&attributes);
+            close(input[0]);
+            close(output[1]);
+
+            if(spawned != 0) {
+                close(input[1]);
+                close(output[0]);
+                if(cancelled)
+                    return *(result = SOLVER_ANSWER::CANCELLED);
+                error = "could not start " + command.front();
+                return *(result = SOLVER_ANSWER::FAILED);
+            }
+
+            pid = child;
+        }
+
+        // the watchdog kills the process once the time is up, whatever it is doing
+        bool done = false, timedOut = false;
+        std::condition_variable finished;
+        std::thread watchdog {[&]() {
+            if(timeout.count() <= 0)
+                return;
+            std::unique_lock<std::mutex> lock {mutex};
+            if(!finished.wait_for(lock, timeout, [&]() { return done; })) {
+                timedOut = true;
+                kill(-pid, SIGKILL);
+            }
+        }};
+
+        // written on its own thread, the solver may answer before it has read everything
+        std::thread writer {[&]() {
+            // a killed solver closes the pipe, the write fails instead of raising SIGPIPE
+            sigset_t pipeSignal;
+            sigemptyset(&pipeSignal);
+            sigaddset(&pipeSignal, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+
+            send(input[1]);
+            close(input[1]);
+        }};
+
+        std::string text;
+        char chunk[1 << 16];
+        for(ssize_t n = read(output[0], chunk, sizeof(chunk)); n != 0; n = read(output[0], chunk, sizeof(chunk))) {
+            if(n > 0)
+                text.append(chunk, (size_t) n);
+            else if(errno != EINTR)
+                break;
+        }
+        close(output[0]);
+
+        writer.join();
+
+        // until it is reaped the exited process keeps its ID, so the group cancel and the watchdog kill
+        // cannot be reused by another process: wait for the exit, forget the ID, then reap
+        siginfo_t info;
+        while(waitid(P_PID, (id_t) child, &info, WEXITED | WNOWAIT) != 0 && errno == EINTR);
+
+        bool stopped;
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            pid = -1;
+            done = true;
+            stopped = cancelled;
+        }
+        finished.notify_all();
+        watchdog.join();
+
+        int status = 0;
+        while(waitpid(child, &status, 0) < 0 && errno == EINTR);
+
+        if(timedOut)
+            return *(result = SOLVER_ANSWER::TIMEOUT);
+        if(stopped)
+            return *(result = SOLVER_ANSWER::CANCELLED);
+
+        // the answer of check-sat, then the values or an error if there is no model
+        std::vector<Term> terms;
+        size_t pos = 0;
+        for(std::optional<Term> term = parse(text, pos); term; term = parse(text, pos))
+            terms.push_back(std::move(*term));
+
+        size_t i = 0;
+        while(i < terms.size() && terms.at(i).atom != "sat" && terms.at(i).atom != "unsat" && terms.at(i).atom != "unknown") {
+            error += toString(terms.at(i)) + '\n';
+            i++;
+        }
+
+        if(i == terms.size()) {
+            if(error.empty())
+                error = command.front() + " did not answer, exit status " + std::to_string(status);
+            return *(result = SOLVER_ANSWER::FAILED);
+        }
+
+        if(terms.at(i).atom == "unsat")
+            return *(result = SOLVER_ANSWER::UNSAT);
+        if(terms.at(i).atom == "unknown")
+            return *(result = SOLVER_ANSWER::UNKNOWN);
+
+        if(i + 1 < terms.size() && terms.at(i + 1).list.size() == std::max<size_t>(queries, 1)) {
+            if(!readModel(terms.at(i + 1))) {
+                model.reset();
+                return *(result = SOLVER_ANSWER::FAILED);
+            }
+        }
+        else
+            error += i + 1 < terms.size() ? toString(terms.at(i + 1)) : "no values after sat";
+
+        return *(result = SOLVER_ANSWER::SAT);
+    }
+
+    template<typename ID>
+    void ExternalSolver<ID>::send(const int &fd) const {
+
+        PipeBuffer buffer {fd};
+        std::ostream ostr {&buffer};
+        SmtWriter out {ostr};
+
+        out << "(set-option :produce-models true)\n";
+        this->problem.print(out, objective);
+
+        out << "(get-value (";
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            if(asgn.isOptional())
+                printActive(out, asgn) << ' ';
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots())
+                printSlot(out, aid, sid) << ' ';
+        }
+        for(const auto &[type, cid] : components)
+            out.symbol("c", cid) << ' ';
+        for(const size_t &handle : softRules)
+            out.symbol("r", handle) << ' ';
+        // get-value needs at least one term
+        out << (queries == 0 ? "true))\n" : "))\n");
+
+        out << "(exit)\n";
+    }
+
+    template<typename ID>
+    bool ExternalSolver<ID>::readModel(const Term &values) {
+
+        model.emplace();
+
+        // the value of the i-th term of get-value
+        size_t next = 0;
+        const auto value = [&]() {
+            const Term &pair = values.list.at(next++);
+            return pair.list.size() == 2 ? toString(pair.list.at(1)) : std::string{};
+        };
+
+        // slots of active assignments with their values, the components are only known afterwards
+        std::vector<std::tuple<ID, ID, std::string>> filled;
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            const bool active = !asgn.isOptional() || value() == "true";
+            if(!active)
+                model->addUnfilled(aid, asgn.getWeight());
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                std::string v = value();
+                if(active)
+                    filled.emplace_back(aid, sid, std::move(v));
+            }
+        }
+
+        // the components by the value the solver gave them, per type
+        std::map<ID, std::unordered_map<std::string, ID>> byValue;
+        for(const auto &[type, cid] : components)
+            byValue[type].emplace(value(), cid);
+
+        for(const auto &[aid, sid, v] : filled) {
+            const auto &candidates = byValue[this->problem.getAssignment(aid).getSlot(sid).type];
+            const auto it = candidates.find(v);
+            if(it == candidates.end()) {
+                std::ostringstream text;
+                text << command.front() << " gave slot " << sid << " of assignment " << aid << " the value " << v
+                     << ", which is no component";
+                error += text.str();
+                return false;
+            }
+
+            model->setComponent(aid, sid, it->second);
+        }
+
+        const std::vector<Rule<ID>> &rules = this->problem.getRules();
+        for(const size_t &handle : softRules)
+            if(value() != "true")
+                model->addViolation(handle, rules.at(handle).getWeight());
+
+        return true;
+    }
+
+    template<typename ID>
+    std::optional<typename ExternalSolver<ID>::Term> ExternalSolver<ID>::parse(const std::string &text, size_t &pos) {
+
+        // whitespace and ; comments
+        while(pos < text.size() && (std::isspace((unsigned char) text.at(pos)) || text.at(pos) == ';')) {
+            if(text.at(pos) == ';')
+                while(pos < text.size() && text.at(pos) != '\n')
+                    pos++;
+            else
+                pos++;
+        }
+
+        if(pos >= text.size() || text.at(pos) == ')')
+            return std::nullopt;
+
+        Term term;
+
+        if(text.at(pos) == '(') {
+            pos++;
+            for(std::optional<Term> sub = parse(text, pos); sub; sub = parse(text, pos))
+                term.list.push_back(std::move(*sub));
+            // the closing parenthesis, unless the output was cut off
+            if(pos < text.size())
+                pos++;
+            return term;
+        }
+
+        // quoted symbols and strings end at their closing character, "" is an escaped quote
+        if(text.at(pos) == '|' || text.at(pos) == '"') {
+            const char quote = text.at(pos);
+            size_t end = pos + 1;
+            while(end < text.size() && (text.at(end) != quote || (quote == '"' && end + 1 < text.size() && text.at(end + 1) == '"')))
+                end += text.at(end) == quote ? 2 : 1;
+            term.atom = text.substr(pos, std::min(end + 1, text.size()) - pos);
+            pos = end + 1;
+            return term;
+        }
+
+        const size_t start = pos;
+        while(pos < text.size() && !std::isspace((unsigned char) text.at(pos)) && text.at(pos) != '(' && text.at(pos) != ')')
+            pos++;
+        term.atom = text.substr(start, pos - start);
+
+        return term;
+    }
+
+    template<typename ID>
+    std::string ExternalSolver<ID>::toString(const Term &term) {
+
+        if(!term.atom.empty())
+            return term.atom;
+
+        std::string text = "(";
+        for(const Term &sub : term.list)
+            text += (text.size() > 1 ? " " : "") + toString(sub);
+
+        return text + ")";
+    }
+
+    template<typename ID>
+    Model<ID> ExternalSolver<ID>::getModel() {
+
+        if(run() != SOLVER_ANSWER::SAT || !model)
+            return Model<ID>{};
+
+        return *model;
+    }
+
+    template<typename ID>
+    bool ExternalSolver<ID>::isSAT() {
+        return run() == SOLVER_ANSWER::SAT;
+    }
+
+    template<typename ID>
+    void ExternalSolver<ID>::cancel() {
+
+        std::lock_guard<std::mutex> lock {mutex};
+
+        cancelled = true;
+        if(pid > 0)
+            kill(-pid, SIGKILL);
+    }
+
+    template<typename ID>
+    const std::string &ExternalSolver<ID>::getError() const {
+        return error;
+    }
+
+    template<typename ID>
+    typename ExternalSolver<ID>::PipeBuffer::int_type ExternalSolver<ID>::PipeBuffer::overflow(int_type c) {
+
+        if(traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+
+        const char byte = traits_type::to_char_type(c);
+        return xsputn(&byte, 1) == 1 ? c : traits_type::eof();
+    }
+
+    template<typename ID>
+    std::streamsize ExternalSolver<ID>::PipeBuffer::xsputn(const char *s, std::streamsize n) {
+
+        std::streamsize written = 0;
+        while(written < n) {
+            const ssize_t w = write(fd, s + written, (size_t) (n - written));
+            if(w < 0 && errno == EINTR)
+                continue;
+            if(w <= 0)
+                break;
+            written += w;
+        }
+
+        return written;
+    }
+
+}
+
+#endif //OMTSCHED_EXTERNALSOLVER_H
@@ -0,0 +1,65 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_OPTIONSLS_H
+#define OMTSCHED_OPTIONSLS_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace omtsched {
+
+    /*
+     * Which moves the local search takes.
+     * SIMULATED_ANNEALING: one random move per step, a worse one with a probability that falls with the temperature
+     * TABU:                the best of a sample of moves, even if it is worse, but no variable returns to a value
+     *                      it recently left unless that gives a new best model
+     */
+    enum class ACCEPTANCE {
+        SIMULATED_ANNEALING, TABU
+    };
+
+    struct OptionsLS {
+
+        ACCEPTANCE acceptance = ACCEPTANCE::SIMULATED_ANNEALING;
+
+        // the search stops after this time with the best model found, local search never proves optimality
+        std::chrono::milliseconds timeout {10000};
+
+        // moves per chain, 0 for no limit besides the timeout
+        size_t iterations = 0;
+
+        // independent chains, each in a thread of its own
+        unsigned chains = 1;
+
+        // chains publish their best model this often and continue from the best of all chains
+        // if it is better than their own, 0 shares only at the end
+        std::chrono::milliseconds sharing {500};
+
+        // chain i uses randomSeed + i
+        unsigned randomSeed = 0;
+
+        // share of the moves that swap the components of two assignments in the same slot,
+        // the others change a single slot or fill or empty an optional assignment
+        double swapRate = 0.3;
+
+        // share of the moves that change a variable of a violated constraint, the others pick one at random
+        double focusRate = 0.7;
+
+        // simulated annealing: the temperature falls geometrically from start to end over the timeout
+        // or the iterations, a start of 0 is estimated from the moves out of the greedy model
+        double startTemperature = 0;
+        double endTemperature = 0.05;
+
+        // tabu search: moves sampled per step and iterations for which a variable may not return to a value
+        size_t neighbourhood = 32;
+        size_t tenure = 10;
+
+        // penalty of each violated hard constraint, 0 for one more than all weights together
+        long hardWeight = 0;
+    };
+
+}
+
+#endif //OMTSCHED_OPTIONSLS_H
@@ -0,0 +1,940 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_TRANSLATORLS_H
+#define OMTSCHED_TRANSLATORLS_H
+
+#include "../cp/DomainTranslator.h"
+#include "OptionsLS.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * Searches a problem locally for a good model within a time limit, for problems too large to solve exactly.
+     * It works on the same grounding as the CP translator, but keeps a complete value for every variable.
+     * A chain starts from a greedy model and changes single slots, swaps the components of two assignments
+     * in the same slot, or fills and empties optional assignments. Every violated hard constraint costs
+     * hardWeight, on top of the weights of violated soft rules and unfilled assignments.
+     * The score is kept up to date incrementally: a change re-evaluates the tests of the variable and
+     * passes flipped truth values up the AND/OR graph by counting the false (AND) or true (OR) children.
+     * Moves are accepted by simulated annealing or tabu search. Several chains run in threads of their own
+     * and continue from the best model of all chains at each sharing interval.
+     * A model is returned only if it violates no hard rule; it is not proven to be optimal.
+     */
+    template<typename ID>
+    class TranslatorLS : public DomainTranslator<ID> {
+    public:
+        /**
+         * @throws std::invalid_argument if a weight is negative or a rule has a condition type the native
+         * translators do not support, TranslatorZ3 solves those problems
+         */
+        TranslatorLS(const Problem<ID> &problem, const OptionsLS &options = {});
+
+        void solve() override;
+
+        /**
+         * Runs the chains until the timeout or the iteration limit, the best model is kept
+         * @return true if a model without violated hard rules was found
+         */
+        bool search();
+
+        Model<ID> getModel() override;
+
+        bool isSAT() override;
+
+        /**
+         * Stops the chains, which keep the best model found so far. Can be called from any thread
+         */
+        void cancel();
+
+        /**
+         * @return the moves of all chains together
+         */
+        size_t getIterationCount() const;
+
+        /**
+         * @return the score of the best values found: their penalty plus hardWeight per violated hard constraint
+         */
+        long getScore() const;
+
+    private:
+        using Variable = typename DomainTranslator<ID>::Variable;
+        using Node = typename DomainTranslator<ID>::Node;
+        using KIND = typename DomainTranslator<ID>::KIND;
+        using AllDifferent = typename DomainTranslator<ID>::AllDifferent;
+
+        // a new value for a variable, and for a second one if it is a swap
+        struct Move {
+            int var = -1;
+            size_t value = 0;
+            int other = -1;
+            size_t otherValue = 0;
+        };
+
+        // the values of one chain and everything that depends on them
+        class Chain {
+        public:
+            Chain(const TranslatorLS &translator, const unsigned &seed);
+
+            // evaluates all constraints from scratch
+            void reset(const std::vector<size_t> &values);
+
+            // a value for each variable in the order of the assignments, the best for the values before it
+            void construct();
+
+            void setValue(const int &var, const size_t &value);
+
+            // applies the move and returns the move back
+            Move apply(const Move &move);
+
+            long getScore() const;
+
+            size_t getViolations() const;
+
+            size_t getValue(const int &var) const;
+
+            // the values with the soft rule variables set, 0 for every broken rule
+            std::vector<size_t> getValues() const;
+
+            // a variable of a random violated constraint, -1 if none is violated
+            int getFocus();
+
+            std::mt19937 random;
+
+        private:
+            void flip(const int &node, const bool &truth);
+
+            // a constraint of the guard (a soft rule variable, or -1 for hard) breaks or is repaired
+            void account(const int &guard, const int &delta);
+
+            void list(const size_t &violation);
+            void unlist(const size_t &violation);
+
+            void hold(const size_t &distinct, const size_t &entry);
+            void release(const size_t &distinct, const size_t &entry);
+
+            const TranslatorLS &ls;
+
+            std::vector<size_t> values;
+            std::vector<char> truth;
+            // per AND node its false children, per OR node its true children
+            std::vector<size_t> counts;
+
+            // per Distinct and component, the active entries holding it, and per entry its place in the list
+            std::vector<std::vector<size_t>> holding;
+            std::vector<std::vector<std::pair<size_t, size_t>>> places;
+
+            // the violated constraints, followed by the components of a Distinct with several holders
+            std::vector<size_t> violations;
+            std::vector<size_t> positions;
+
+            // per soft rule variable its violated constraints
+            std::vector<size_t> broken;
+            size_t hard = 0;
+            long soft = 0;
+        };
+
+        void setupSearch();
+
+        void run(const size_t &index);
+
+        bool randomMove(Chain &chain, Move &move);
+
+        bool isTabu(const std::vector<size_t> &tabu, const Move &move, const size_t &iteration) const;
+
+        // offers a chain's best values, the best of all is kept
+        void publish(const std::vector<size_t> &values, const long &score, const size_t &violations);
+
+        bool isStopped() const;
+
+        const OptionsLS options;
+        long hardWeight = 0;
+
+        // the variables that moves change: free slots and activations, in the order of the assignments
+        std::vector<int> searchable;
+        // per variable the first index of its values in the tabu list
+        std::vector<size_t> valueOffsets;
+        // the searchable slots with the same name and type, and the group of each variable (-1 for none)
+        std::vector<std::vector<int>> groups;
+        std::vector<int> groupOf;
+
+        std::vector<std::vector<int>> atomWatchers;
+        std::vector<std::vector<std::pair<size_t, size_t>>> distinctWatchers;
+        // per node the constraints it is the top of, per constraint some of its searchable variables
+        std::vector<std::vector<size_t>> constraintsOf;
+        std::vector<std::vector<int>> constraintVars;
+        // per Distinct the index of its first component among the violations, after the constraints
+        std::vector<size_t> distinctBase;
+        size_t violationCount = 0;
+
+        std::mutex mutex;
+        std::vector<size_t> best;
+        long bestScore = std::numeric_limits<long>::max();
+        size_t bestViolations = 0;
+        bool searched = false;
+
+        std::atomic<bool> cancelled {false};
+        // a chain found a model without any penalty
+        std::atomic<bool> finished {false};
+        std::atomic<size_t> iterationCount {0};
+        std::chrono::steady_clock::time_point deadline;
+
+        static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+        // the variables of a constraint that focused moves choose from
+        static constexpr size_t FOCUS_LIMIT = 256;
+        // moves between checks of the clock and the other chains
+        static constexpr size_t CHECK_INTERVAL = 64;
+        // without a limit the temperature falls over this many moves, then starts again
+        static constexpr size_t COOLING_CYCLE = size_t{1} << 20;
+
+    };
+
+    template<typename ID>
+    TranslatorLS<ID>::TranslatorLS(const Problem<ID> &problem, const OptionsLS &options) :
+    DomainTranslator<ID>{problem}, options{options} {
+        setupSearch();
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::setupSearch() {
+
+        const std::vector<Variable> &vars = this->vars;
+        const std::vector<Node> &nodes = this->nodes;
+        const std::vector<AllDifferent> &distincts = this->distincts;
+
+        hardWeight = options.hardWeight;
+        if(hardWeight <= 0) {
+            hardWeight = 1;
+            for(const Variable &var : vars)
+                hardWeight += var.cost;
+        }
+
+        const auto isSearchable = [&](const int &var) {
+            return vars.at(var).fixed < 0 && vars.at(var).size > 1;
+        };
+
+        // slots before their activation, so that the greedy model knows what filling an assignment costs
+        std::map<std::pair<ID, ID>, int> named;
+        groupOf.assign(vars.size(), -1);
+
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                const int var = this->slots.at(std::make_pair(aid, sid));
+                if(!isSearchable(var))
+                    continue;
+
+                searchable.push_back(var);
+
+                auto it = named.find(std::make_pair(sid, slot.type));
+                if(it == named.end()) {
+                    it = named.emplace(std::make_pair(sid, slot.type), (int) groups.size()).first;
+                    groups.emplace_back();
+                }
+                groups.at(it->second).push_back(var);
+                groupOf.at(var) = it->second;
+            }
+
+            if(asgn.isOptional())
+                searchable.push_back(this->activations.at(aid));
+        }
+
+        size_t offset = 0;
+        for(const Variable &var : vars) {
+            valueOffsets.push_back(offset);
+            offset += var.size;
+        }
+
+        atomWatchers.resize(vars.size());
+        distinctWatchers.resize(vars.size());
+
+        constraintsOf.resize(nodes.size());
+        for(size_t c = 0; c < this->constraints.size(); c++)
+            constraintsOf.at(this->constraints.at(c).first).push_back(c);
+
+        // tests left over from gates that simplified away do not matter
+        for(size_t node = 0; node < nodes.size(); node++)
+            if(nodes.at(node).kind == KIND::ATOM && (!nodes.at(node).parents.empty() || !constraintsOf.at(node).empty()))
+                atomWatchers.at(nodes.at(node).var).push_back((int) node);
+
+        for(size_t d = 0; d < distincts.size(); d++) {
+            const AllDifferent &distinct = distincts.at(d);
+            for(size_t entry = 0; entry < distinct.entries.size(); entry++) {
+                if(distinct.entries.at(entry).first >= 0)
+                    distinctWatchers.at(distinct.entries.at(entry).first).emplace_back(d, entry);
+                distinctWatchers.at(distinct.entries.at(entry).second).emplace_back(d, entry);
+            }
+        }
+
+        std::vector<size_t> seen(std::max(nodes.size(), vars.size()), NONE);
+
+        for(size_t c = 0; c < this->constraints.size(); c++) {
+
+            const int root = this->constraints.at(c).first;
+
+            // the searchable variables below the root, depth first
+            constraintVars.emplace_back();
+            std::vector<int> stack {root};
+            while(!stack.empty() && constraintVars.back().size() < FOCUS_LIMIT) {
+
+                const int node = stack.back();
+                stack.pop_back();
+
+                if(seen.at(node) == c)
+                    continue;
+                seen.at(node) = c;
+
+                const Node &n = nodes.at(node);
+                if(n.kind != KIND::ATOM)
+                    stack.insert(stack.end(), n.children.begin(), n.children.end());
+                else if(isSearchable(n.var))
+                    constraintVars.back().push_back(n.var);
+            }
+
+            std::sort(constraintVars.back().begin(), constraintVars.back().end());
+            constraintVars.back().erase(std::unique(constraintVars.back().begin(), constraintVars.back().end()), constraintVars.back().end());
+        }
+
+        violationCount = this->constraints.size();
+        for(const AllDifferent &distinct : distincts) {
+            distinctBase.push_back(violationCount);
+            violationCount += distinct.ordinals.front().size();
+        }
+    }
+
+    // ------------------------- chain -------------------------
+
+    template<typename ID>
+    TranslatorLS<ID>::Chain::Chain(const TranslatorLS &translator, const unsigned &seed) : random{seed}, ls{translator} {
+
+        holding.resize(ls.violationCount - ls.constraints.size());
+        for(const AllDifferent &distinct : ls.distincts)
+            places.emplace_back(distinct.entries.size(), std::make_pair(NONE, NONE));
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::reset(const std::vector<size_t> &initial) {
+
+        const std::vector<Node> &nodes = ls.nodes;
+
+        values = initial;
+        truth.assign(nodes.size(), 0);
+        counts.assign(nodes.size(), 0);
+
+        // children come before their parents
+        for(size_t node = 0; node < nodes.size(); node++) {
+
+            const Node &n = nodes.at(node);
+
+            if(n.kind == KIND::ATOM) {
+                const size_t value = values.at(n.var);
+                truth[node] = (n.mask.at(value / 64) >> (value % 64)) & 1;
+                continue;
+            }
+
+            for(const int &child : n.children)
+                if((bool) truth[child] == (n.kind == KIND::OR))
+                    counts[node]++;
+
+            truth[node] = n.kind == KIND::AND ? counts[node] == 0 : counts[node] > 0;
+        }
+
+        violations.clear();
+        positions.assign(ls.violationCount, NONE);
+        broken.assign(ls.vars.size(), 0);
+        hard = 0;
+        soft = 0;
+
+        for(size_t c = 0; c < ls.constraints.size(); c++)
+            if(!truth[ls.constraints.at(c).first]) {
+                list(c);
+                account(ls.constraints.at(c).second, 1);
+            }
+
+        for(std::vector<size_t> &holders : holding)
+            holders.clear();
+
+        for(size_t d = 0; d < ls.distincts.size(); d++)
+            for(size_t entry = 0; entry < ls.distincts.at(d).entries.size(); entry++) {
+                places.at(d).at(entry) = std::make_pair(NONE, NONE);
+                const int activation = ls.distincts.at(d).entries.at(entry).first;
+                if(activation < 0 || values.at(activation) == 1)
+                    hold(d, entry);
+            }
+
+        for(const auto &[aid, activation] : ls.activations)
+            if(values.at(activation) == 0)
+                soft += ls.vars.at(activation).cost;
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::construct() {
+
+        const std::vector<Variable> &vars = ls.vars;
+
+        // fixed slots keep their component, the others start anywhere and every assignment is filled
+        std::vector<size_t> initial(vars.size(), 0);
+        for(size_t var = 0; var < vars.size(); var++) {
+            if(vars.at(var).fixed >= 0)
+                initial.at(var) = vars.at(var).fixed;
+            else if(vars.at(var).binary)
+                initial.at(var) = 1;
+            else
+                initial.at(var) = random() % vars.at(var).size;
+        }
+
+        reset(initial);
+
+        for(const int &var : ls.searchable) {
+
+            // the remaining variables keep their random values
+            if(ls.isStopped())
+                break;
+
+            const size_t size = vars.at(var).size;
+            const size_t start = random() % size;
+
+            size_t bestValue = values.at(var);
+            long bestScore = getScore();
+
+            for(size_t i = 0; i < size; i++) {
+                const size_t value = (start + i) % size;
+                setValue(var, value);
+                if(getScore() < bestScore) {
+                    bestValue = value;
+                    bestScore = getScore();
+                }
+            }
+
+            setValue(var, bestValue);
+        }
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::setValue(const int &var, const size_t &value) {
+
+        if(values.at(var) == value)
+            return;
+
+        values.at(var) = value;
+
+        for(const int &atom : ls.atomWatchers.at(var)) {
+            const std::vector<typename DomainTranslator<ID>::Word> &mask = ls.nodes.at(atom).mask;
+            const bool test = (mask.at(value / 64) >> (value % 64)) & 1;
+            if(test != (bool) truth[atom])
+                flip(atom, test);
+        }
+
+        for(const auto &[d, entry] : ls.distinctWatchers.at(var)) {
+
+            const auto &[activation, slot] = ls.distincts.at(d).entries.at(entry);
+
+            if(var == activation) {
+                if(value == 1)
+                    hold(d, entry);
+                else
+                    release(d, entry);
+            }
+            else if(activation < 0 || values.at(activation) == 1) {
+                release(d, entry);
+                hold(d, entry);
+            }
+        }
+
+        // the variable is an activation if it has a cost, soft rule variables are never set
+        if(ls.vars.at(var).cost > 0)
+            soft += value == 0 ? ls.vars.at(var).cost : -ls.vars.at(var).cost;
+    }
+
+    template<typename ID>
+    typename TranslatorLS<ID>::Move TranslatorLS<ID>::Chain::apply(const Move &move) {
+
+        Move back {move.var, values.at(move.var), move.other, move.other >= 0 ? values.at(move.other) : 0};
+
+        setValue(move.var, move.value);
+        if(move.other >= 0)
+            setValue(move.other, move.otherValue);
+
+        return back;
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::flip(const int &node, const bool &value) {
+
+        truth[node] = value;
+
+        for(const size_t &c : ls.constraintsOf.at(node)) {
+            if(value)
+                unlist(c);
+            else
+                list(c);
+            account(ls.constraints.at(c).second, value ? -1 : 1);
+        }
+
+        for(const int &parent : ls.nodes.at(node).parents) {
+
+            bool result;
+            if(ls.nodes.at(parent).kind == KIND::AND) {
+                counts[parent] += value ? -1 : 1;
+                result = counts[parent] == 0;
+            }
+            else {
+                counts[parent] += value ? 1 : -1;
+                result = counts[parent] > 0;
+            }
+
+            if(result != (bool) truth[parent])
+                flip(parent, result);
+        }
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::account(const int &guard, const int &delta) {
+
+        if(guard < 0) {
+            hard += delta;
+            return;
+        }
+
+        // a soft rule costs its weight once, however many of its constraints are violated
+        if(broken.at(guard) == 0 && delta > 0)
+            soft += ls.vars.at(guard).cost;
+        broken.at(guard) += delta;
+        if(broken.at(guard) == 0 && delta < 0)
+            soft -= ls.vars.at(guard).cost;
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::list(const size_t &violation) {
+        positions.at(violation) = violations.size();
+        violations.push_back(violation);
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::unlist(const size_t &violation) {
+
+        const size_t position = positions.at(violation);
+        const size_t last = violations.back();
+
+        violations.at(position) = last;
+        positions.at(last) = position;
+        violations.pop_back();
+        positions.at(violation) = NONE;
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::hold(const size_t &d, const size_t &entry) {
+
+        const AllDifferent &distinct = ls.distincts.at(d);
+        const size_t component = distinct.components.at(distinct.types.at(entry)).at(values.at(distinct.entries.at(entry).second));
+        const size_t index = ls.distinctBase.at(d) + component;
+
+        std::vector<size_t> &holders = holding.at(index - ls.constraints.size());
+        places.at(d).at(entry) = std::make_pair(index, holders.size());
+        holders.push_back(entry);
+
+        // every holder after the first is a violation
+        if(holders.size() >= 2) {
+            account(distinct.guard, 1);
+            if(holders.size() == 2)
+                list(index);
+        }
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::Chain::release(const size_t &d, const size_t &entry) {
+
+        const auto [index, position] = places.at(d).at(entry);
+        if(index == NONE)
+            return;
+
+        std::vector<size_t> &holders = holding.at(index - ls.constraints.size());
+        const size_t last = holders.back();
+
+        holders.at(position) = last;
+        places.at(d).at(last).second = position;
+        holders.pop_back();
+        places.at(d).at(entry) = std::make_pair(NONE, NONE);
+
+        if(!holders.empty()) {
+            account(ls.distincts.at(d).guard, -1);
+            if(holders.size() == 1)
+                unlist(index);
+        }
+    }
+
+    template<typename ID>
+    long TranslatorLS<ID>::Chain::getScore() const {
+        return (long) hard * ls.hardWeight + soft;
+    }
+
+    template<typename ID>
+    size_t TranslatorLS<ID>::Chain::getViolations() const {
+        return hard;
+    }
+
+    template<typename ID>
+    size_t TranslatorLS<ID>::Chain::getValue(const int &var) const {
+        return values.at(var);
+    }
+
+    template<typename ID>
+    std::vector<size_t> TranslatorLS<ID>::Chain::getValues() const {
+
+        std::vector<size_t> result = values;
+        for(const auto &[handle, var] : ls.softRules)
+            result.at(var) = broken.at(var) > 0 ? 0 : 1;
+
+        return result;
+    }
+
+    template<typename ID>
+    int TranslatorLS<ID>::Chain::getFocus() {
+
+        if(violations.empty())
+            return -1;
+
+        const size_t violation = violations.at(random() % violations.size());
+
+        if(violation < ls.constraints.size()) {
+            const std::vector<int> &candidates = ls.constraintVars.at(violation);
+            return candidates.empty() ? -1 : candidates.at(random() % candidates.size());
+        }
+
+        // a slot that holds a component twice
+        const std::vector<size_t> &holders = holding.at(violation - ls.constraints.size());
+        const auto it = std::upper_bound(ls.distinctBase.begin(), ls.distinctBase.end(), violation);
+        const size_t d = it - ls.distinctBase.begin() - 1;
+
+        return ls.distincts.at(d).entries.at(holders.at(random() % holders.size())).second;
+    }
+
+    // ------------------------- search -------------------------
+
+    template<typename ID>
+    bool TranslatorLS<ID>::randomMove(Chain &chain, Move &move) {
+
+        const std::vector<Variable> &vars = this->vars;
+        std::uniform_real_distribution<double> chance {0, 1};
+
+        int var = -1;
+        if(chance(chain.random) < options.focusRate)
+            var = chain.getFocus();
+        // a Distinct can also point at a fixed slot
+        if(var < 0 || vars.at(var).fixed >= 0 || vars.at(var).size < 2)
+            var = searchable.at(chain.random() % searchable.size());
+
+        // a slot of an unfilled assignment does not matter until it is filled
+        if(vars.at(var).owner >= 0 && chain.getValue(vars.at(var).owner) == 0)
+            var = vars.at(var).owner;
+
+        move = Move{var, 0};
+
+        if(groupOf.at(var) >= 0 && chance(chain.random) < options.swapRate) {
+            const std::vector<int> &group = groups.at(groupOf.at(var));
+            const int other = group.at(chain.random() % group.size());
+            if(chain.getValue(other) != chain.getValue(var)) {
+                move = Move{var, chain.getValue(other), other, chain.getValue(var)};
+                return true;
+            }
+        }
+
+        // any other value
+        const size_t value = chain.random() % (vars.at(var).size - 1);
+        move.value = value < chain.getValue(var) ? value : value + 1;
+
+        return true;
+    }
+
+    template<typename ID>
+    bool TranslatorLS<ID>::isTabu(const std::vector<size_t> &tabu, const Move &move, const size_t &iteration) const {
+        return tabu.at(valueOffsets.at(move.var) + move.value) > iteration
+               || (move.other >= 0 && tabu.at(valueOffsets.at(move.other) + move.otherValue) > iteration);
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::publish(const std::vector<size_t> &values, const long &score, const size_t &violations) {
+
+        std::lock_guard<std::mutex> lock {mutex};
+
+        if(score < bestScore) {
+            best = values;
+            bestScore = score;
+            bestViolations = violations;
+        }
+
+        if(score == 0)
+            finished = true;
+    }
+
+    template<typename ID>
+    bool TranslatorLS<ID>::isStopped() const {
+        return cancelled || finished || (options.timeout.count() > 0 && std::chrono::steady_clock::now() >= deadline);
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::run(const size_t &index) {
+
+        Chain chain {*this, options.randomSeed + (unsigned) index};
+        chain.construct();
+
+        std::vector<size_t> chainBest = chain.getValues();
+        long chainScore = chain.getScore();
+        size_t chainViolations = chain.getViolations();
+        // the current values are as good as chainBest, but were not copied yet
+        bool unsaved = false;
+
+        const auto save = [&]() {
+            if(unsaved) {
+                chainBest = chain.getValues();
+                unsaved = false;
+            }
+        };
+
+        const auto improve = [&]() {
+            if(chain.getScore() < chainScore) {
+                chainScore = chain.getScore();
+                chainViolations = chain.getViolations();
+                unsaved = true;
+            }
+        };
+
+        publish(chainBest, chainScore, chainViolations);
+
+        if(searchable.empty() || chainScore == 0)
+            return;
+
+        const auto start = std::chrono::steady_clock::now();
+        auto nextShare = start + options.sharing;
+
+        std::uniform_real_distribution<double> chance {0, 1};
+        Move move;
+
+        // the start temperature accepts the average worsening of a random move with a probability of 1/2
+        double startTemperature = options.startTemperature;
+        if(options.acceptance == ACCEPTANCE::SIMULATED_ANNEALING && startTemperature <= 0) {
+
+            double sum = 0;
+            size_t worse = 0;
+            for(size_t i = 0; i < 100; i++) {
+                if(!randomMove(chain, move))
+                    continue;
+                const long before = chain.getScore();
+                const Move back = chain.apply(move);
+                if(chain.getScore() > before) {
+                    sum += (double) (chain.getScore() - before);
+                    worse++;
+                }
+                chain.apply(back);
+            }
+            startTemperature = worse > 0 ? sum / (double) worse / std::log(2.0) : 1;
+        }
+
+        const double endTemperature = std::min(options.endTemperature, startTemperature);
+        double temperature = startTemperature;
+
+        std::vector<size_t> tabu;
+        if(options.acceptance == ACCEPTANCE::TABU)
+            tabu.assign(valueOffsets.back() + this->vars.back().size, 0);
+
+        size_t iteration = 0;
+
+        while(options.iterations == 0 || iteration < options.iterations) {
+
+            iteration++;
+
+            if(iteration % CHECK_INTERVAL == 0) {
+
+                iterationCount += CHECK_INTERVAL;
+                if(isStopped())
+                    break;
+
+                const auto now = std::chrono::steady_clock::now();
+
+                // the share of the search that is done, by time or by moves
+                double progress = 0;
+                if(options.timeout.count() > 0)
+                    progress = std::chrono::duration<double>(now - start) / options.timeout;
+                if(options.iterations > 0)
+                    progress = std::max(progress, (double) iteration / (double) options.iterations);
+                if(options.timeout.count() == 0 && options.iterations == 0)
+                    progress = (double) (iteration % COOLING_CYCLE) / COOLING_CYCLE;
+
+                temperature = startTemperature * std::pow(endTemperature / startTemperature, std::min(progress, 1.0));
+
+                if(options.sharing.count() > 0 && now >= nextShare) {
+
+                    nextShare = now + options.sharing;
+
+                    save();
+                    publish(chainBest, chainScore, chainViolations);
+
+                    std::lock_guard<std::mutex> lock {mutex};
+                    if(bestScore < chainScore) {
+                        chain.reset(best);
+                        chainBest = best;
+                        chainScore = bestScore;
+                        chainViolations = bestViolations;
+                    }
+                }
+            }
+
+            if(options.acceptance == ACCEPTANCE::SIMULATED_ANNEALING) {
+
+                if(!randomMove(chain, move))
+                    continue;
+
+                const long before = chain.getScore();
+                const Move back = chain.apply(move);
+                const long delta = chain.getScore() - before;
+
+                if(delta <= 0) {
+                    improve();
+                    if(chainScore == 0)
+                        break;
+                    continue;
+                }
+
+                if(chance(chain.random) >= std::exp(-(double) delta / temperature)) {
+                    chain.apply(back);
+                    continue;
+                }
+
+                // leaving the best values, which have to be copied first
+                if(unsaved) {
+                    chain.apply(back);
+                    save();
+                    chain.apply(move);
+                }
+                continue;
+            }
+
+            // tabu search: the best allowed move of a sample, a tabu one only if it gives a new best
+            Move chosen;
+            long chosenScore = std::numeric_limits<long>::max();
+
+            for(size_t i = 0; i < options.neighbourhood; i++) {
+
+                if(!randomMove(chain, move))
+                    continue;
+
+                const Move back = chain.apply(move);
+                const long score = chain.getScore();
+                chain.apply(back);
+
+                if(score < chosenScore && (score < chainScore || !isTabu(tabu, move, iteration))) {
+                    chosen = move;
+                    chosenScore = score;
+                }
+            }
+
+            if(chosen.var < 0)
+                continue;
+
+            if(chosenScore > chain.getScore())
+                save();
+
+            const Move back = chain.apply(chosen);
+
+            tabu.at(valueOffsets.at(back.var) + back.value) = iteration + options.tenure + chain.random() % (options.tenure + 1);
+            if(back.other >= 0)
+                tabu.at(valueOffsets.at(back.other) + back.otherValue) = iteration + options.tenure + chain.random() % (options.tenure + 1);
+
+            improve();
+            if(chainScore == 0)
+                break;
+        }
+
+        iterationCount += iteration % CHECK_INTERVAL;
+
+        save();
+        publish(chainBest, chainScore, chainViolations);
+    }
+
+    template<typename ID>
+    bool TranslatorLS<ID>::search() {
+
+        if(searched)
+            return bestScore != std::numeric_limits<long>::max() && bestViolations == 0;
+
+        searched = true;
+
+        if(this->infeasible)
+            return false;
+
+        deadline = std::chrono::steady_clock::now() + options.timeout;
+
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < std::max(1u, options.chains); i++)
+            threads.emplace_back([this, i]() { run(i); });
+
+        run(0);
+
+        for(std::thread &thread : threads)
+            thread.join();
+
+        return bestScore != std::numeric_limits<long>::max() && bestViolations == 0;
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::solve() {
+
+        if(search())
+            std::cout << "SAT" << std::endl;
+        else if(this->infeasible)
+            std::cout << "UNSAT" << std::endl;
+        else
+            std::cout << "UNKNOWN" << std::endl;
+    }
+
+    template<typename ID>
+    Model<ID> TranslatorLS<ID>::getModel() {
+
+        if(!search())
+            return Model<ID>{};
+
+        Model<ID> model = this->makeModel(best);
+
+        // penalties are never negative
+        if(model.getPenalty() == 0)
+            model.setLowerBound(0);
+
+        return model;
+    }
+
+    template<typename ID>
+    bool TranslatorLS<ID>::isSAT() {
+        return search();
+    }
+
+    template<typename ID>
+    void TranslatorLS<ID>::cancel() {
+        cancelled = true;
+    }
+
+    template<typename ID>
+    size_t TranslatorLS<ID>::getIterationCount() const {
+        return iterationCount;
+    }
+
+    template<typename ID>
+    long TranslatorLS<ID>::getScore() const {
+        return bestScore;
+    }
+
+}
+
+#endif //OMTSCHED_TRANSLATORLS_H
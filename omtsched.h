@@ -2,10 +2,19 @@
 #define OMTSCHED_OMTSCHED_H
 
 #include "Translator.h"
+#include "ModelStream.h"
 #include "conditions/BasicConditions.h"
 #include "conditions/BooleanConditions.h"
 #include "conditions/MinMaxConditions.h"
 #include "z3/TranslatorZ3.h"
+#include "z3/PortfolioZ3.h"
+#include "z3/ImportZ3.h"
+#include "z3/CacheZ3.h"
+#include "exporters/DimacsExporter.h"
+#include "exporters/LpExporter.h"
+#include "external/ExternalSolver.h"
+#include "cp/TranslatorCP.h"
+#include "local/TranslatorLS.h"
 
 
 #endif //OMTSCHED_OMTSCHED_H
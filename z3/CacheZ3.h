@@ -0,0 +1,350 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_CACHEZ3_H
+#define OMTSCHED_CACHEZ3_H
+
+#include "ImportZ3.h"
+#include "../ModelStream.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+namespace omtsched {
+
+    /*
+     * Directory of grounded encodings and solutions keyed by Problem::getFingerprint.
+     * An encoding is the SMT-LIB dump of Problem::print, loaded with ImportZ3, so a hit
+     * replaces grounding with reading a file. Every file starts with a header of the problem's sizes and
+     * Problem::getFingerprintCheck, a file whose header does not match is a miss and is replaced, so problems
+     * with the same fingerprint never share an entry. Files are written under a temporary name and renamed,
+     * several processes can share the directory. The least recently used entries are removed
+     * as soon as the directory exceeds its limits.
+     */
+    template<typename ID>
+    class CacheZ3 {
+    public:
+        /**
+         * @param directory created if it does not exist
+         * @param maxBytes size limit of all files in the directory
+         * @param maxEntries limit on the number of problems, 0 for none
+         * @param compress gzip the encodings, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the directory cannot be created
+         */
+        explicit CacheZ3(const std::string &directory, const size_t &maxBytes = size_t{1} << 30,
+                         const size_t &maxEntries = 0, const bool &compress = false);
+
+        /**
+         * Loads the encoding of the problem, the problem is printed into the cache first if it is missing
+         * @param threads used by Problem::print on a miss
+         * @throws std::runtime_error if the encoding cannot be written or read
+         */
+        std::unique_ptr<ImportZ3<ID>> load(const Problem<ID> &problem, const size_t &threads = 1);
+
+        bool contains(const Problem<ID> &problem) const;
+
+        /**
+         * Keeps a solution of the problem, e.g. the model of a previous run
+         * @throws std::runtime_error if the solution cannot be written
+         */
+        void storeSolution(const Problem<ID> &problem, Model<ID> model);
+
+        /**
+         * @return the solution stored for the problem, empty if there is none
+         */
+        std::optional<Model<ID>> loadSolution(const Problem<ID> &problem);
+
+        /**
+         * Removes the least recently used entries until the directory is within its limits
+         */
+        void evict();
+
+        /**
+         * @return size of all entries in bytes
+         */
+        size_t getSize() const;
+
+        size_t getHits() const;
+
+        size_t getMisses() const;
+
+    private:
+
+        std::filesystem::path getEncodingPath(const std::string &key) const;
+        std::filesystem::path getSolutionPath(const std::string &key) const;
+        std::filesystem::path getTemporaryPath(const std::string &key);
+
+        // marks the entry as recently used
+        static void touch(const std::filesystem::path &path);
+
+        static std::string getKey(const Problem<ID> &problem);
+
+        // the first line of the files of the problem, Z3 skips it as a comment
+        static std::string getHeader(const Problem<ID> &problem);
+
+        // true if the file exists and starts with the header
+        bool matches(const std::filesystem::path &path, const std::string &header, const bool &compressed) const;
+        static std::string hex(const uint64_t &value);
+
+        const std::filesystem::path directory;
+        const size_t maxBytes;
+        const size_t maxEntries;
+        const bool compress;
+
+        size_t hits = 0;
+        size_t misses = 0;
+
+        std::mt19937_64 random {std::random_device{}()};
+
+    };
+
+    template<typename ID>
+    CacheZ3<ID>::CacheZ3(const std::string &directory, const size_t &maxBytes, const size_t &maxEntries, const bool &compress) :
+    directory{directory}, maxBytes{maxBytes}, maxEntries{maxEntries}, compress{compress} {
+
+        std::error_code error;
+        std::filesystem::create_directories(this->directory, error);
+        if(error)
+            throw std::runtime_error("could not create the cache directory " + directory + ": " + error.message());
+    }
+
+    template<typename ID>
+    std::unique_ptr<ImportZ3<ID>> CacheZ3<ID>::load(const Problem<ID> &problem, const size_t &threads) {
+
+        const std::string key = getKey(problem);
+        const std::string header = getHeader(problem);
+        const std::filesystem::path path = getEncodingPath(key);
+
+        if(matches(path, header, compress)) {
+            hits++;
+            touch(path);
+            return std::make_unique<ImportZ3<ID>>(problem, path.string(), compress);
+        }
+
+        misses++;
+
+        const std::filesystem::path temporary = getTemporaryPath(key);
+        try {
+            SmtWriter writer {temporary.string(), compress};
+            writer << header;
+            problem.print(writer, SMT_OBJECTIVE::ASSERT_SOFT, threads);
+            writer.flush();
+            if(!writer.good())
+                throw std::runtime_error("could not write to the cache directory");
+        }
+        catch(...) {
+            // evict skips temporary files, nothing else would remove it
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+            throw;
+        }
+        std::filesystem::rename(temporary, path);
+
+        // loaded before evicting, the new entry may not fit on its own
+        auto translator = std::make_unique<ImportZ3<ID>>(problem, path.string(), compress);
+        evict();
+
+        return translator;
+    }
+
+    template<typename ID>
+    bool CacheZ3<ID>::contains(const Problem<ID> &problem) const {
+        return matches(getEncodingPath(getKey(problem)), getHeader(problem), compress);
+    }
+
+    template<typename ID>
+    void CacheZ3<ID>::storeSolution(const Problem<ID> &problem, Model<ID> model) {
+
+        const std::string key = getKey(problem);
+        const std::filesystem::path temporary = getTemporaryPath(key);
+
+        // the binary format stores slots and components by position, its header repeats the fingerprint
+        {
+            std::ofstream out {temporary, std::ios::binary};
+            if(out) {
+                out << getHeader(problem);
+                ModelWriter<ID> writer {problem, out};
+                writer.write(model);
+            }
+
+            // a partial solution would be read as another one
+            if(!out.flush()) {
+                out.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                throw std::runtime_error("could not write to the cache directory");
+            }
+        }
+
+        std::filesystem::rename(temporary, getSolutionPath(key));
+        evict();
+    }
+
+    template<typename ID>
+    std::optional<Model<ID>> CacheZ3<ID>::loadSolution(const Problem<ID> &problem) {
+
+        const std::filesystem::path path = getSolutionPath(getKey(problem));
+        const std::string header = getHeader(problem);
+
+        std::ifstream in {path, std::ios::binary};
+        std::string text(header.size(), '\0');
+        if(!in.read(text.data(), (std::streamsize) text.size()) || text != header)
+            return std::nullopt;
+
+        touch(path);
+
+        ModelReader<ID> reader {problem, in};
+        return reader.read();
+    }
+
+    template<typename ID>
+    void CacheZ3<ID>::evict() {
+
+        struct Entry {
+            std::vector<std::filesystem::path> files;
+            size_t size = 0;
+            std::filesystem::file_time_type used = std::filesystem::file_time_type::min();
+        };
+
+        // the encoding and the solution of a problem are one entry, temporary files are skipped
+        std::map<std::string, Entry> entries;
+        size_t size = 0;
+
+        std::error_code error;
+        for(const auto &file : std::filesystem::directory_iterator(directory, error)) {
+
+            const std::string name = file.path().filename().string();
+            if(!file.is_regular_file(error) || name.find(".tmp") != std::string::npos)
+                continue;
+
+            Entry &entry = entries[name.substr(0, name.find('.'))];
+            entry.files.push_back(file.path());
+            entry.size += file.file_size(error);
+            entry.used = std::max(entry.used, file.last_write_time(error));
+            size += file.file_size(error);
+        }
+
+        std::vector<const Entry *> order;
+        for(const auto &[key, entry] : entries)
+            order.push_back(&entry);
+        std::sort(order.begin(), order.end(), [](const Entry *lhs, const Entry *rhs) { return lhs->used < rhs->used; });
+
+        size_t count = order.size();
+        for(const Entry *entry : order) {
+
+            if(size <= maxBytes && (maxEntries == 0 || count <= maxEntries))
+                break;
+
+            // another process may have removed it already
+            for(const auto &file : entry->files)
+                std::filesystem::remove(file, error);
+
+            size -= entry->size;
+            count--;
+        }
+    }
+
+    template<typename ID>
+    size_t CacheZ3<ID>::getSize() const {
+
+        size_t size = 0;
+
+        std::error_code error;
+        for(const auto &file : std::filesystem::directory_iterator(directory, error))
+            if(file.is_regular_file(error))
+                size += file.file_size(error);
+
+        return size;
+    }
+
+    template<typename ID>
+    size_t CacheZ3<ID>::getHits() const {
+        return hits;
+    }
+
+    template<typename ID>
+    size_t CacheZ3<ID>::getMisses() const {
+        return misses;
+    }
+
+    template<typename ID>
+    std::filesystem::path CacheZ3<ID>::getEncodingPath(const std::string &key) const {
+        return directory / (key + (compress ? ".smt2.gz" : ".smt2"));
+    }
+
+    template<typename ID>
+    std::filesystem::path CacheZ3<ID>::getSolutionPath(const std::string &key) const {
+        return directory / (key + ".model");
+    }
+
+    template<typename ID>
+    std::filesystem::path CacheZ3<ID>::getTemporaryPath(const std::string &key) {
+
+        return directory / (key + "." + hex(random()) + ".tmp");
+    }
+
+    template<typename ID>
+    void CacheZ3<ID>::touch(const std::filesystem::path &path) {
+
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    template<typename ID>
+    std::string CacheZ3<ID>::getKey(const Problem<ID> &problem) {
+
+        return hex(problem.getFingerprint());
+    }
+
+    template<typename ID>
+    std::string CacheZ3<ID>::getHeader(const Problem<ID> &problem) {
+
+        size_t components = 0;
+        for(const ID &type : problem.getComponentTypes())
+            components += problem.getComponents(type).size();
+
+        std::ostringstream text;
+        text << "; omtsched " << components << ' ' << problem.getAssignments().size() << ' '
+             << problem.getRules().size() << ' ' << hex(problem.getFingerprintCheck()) << '\n';
+        return text.str();
+    }
+
+    template<typename ID>
+    bool CacheZ3<ID>::matches(const std::filesystem::path &path, const std::string &header, const bool &compressed) const {
+
+        std::string text(header.size(), '\0');
+
+        if(compressed) {
+#ifdef OMTSCHED_ZLIB
+            gzFile file = gzopen(path.string().c_str(), "rb");
+            if(!file)
+                return false;
+
+            const int n = gzread(file, text.data(), (unsigned) text.size());
+            gzclose(file);
+            return n == (int) text.size() && text == header;
+#else
+            throw std::runtime_error("compressed input needs OMTSCHED_ZLIB");
+#endif
+        }
+
+        std::ifstream in {path, std::ios::binary};
+        return in.read(text.data(), (std::streamsize) text.size()) && text == header;
+    }
+
+    template<typename ID>
+    std::string CacheZ3<ID>::hex(const uint64_t &value) {
+
+        std::ostringstream text;
+        text << std::hex << std::setw(16) << std::setfill('0') << value;
+        return text.str();
+    }
+
+}
+
+#endif //OMTSCHED_CACHEZ3_H
@@ -0,0 +1,298 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_IMPORTZ3_H
+#define OMTSCHED_IMPORTZ3_H
+
+#include "../Translator.h"
+#include <z3++.h>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef OMTSCHED_ZLIB
+#include <zlib.h>
+#endif
+
+namespace omtsched {
+
+    /*
+     * Solves a problem from its SMT-LIB dump instead of grounding it again.
+     * The file has to be written by Problem::print for the same problem, the variables are found
+     * by their names a[assignmentID]s[slotID], act[assignmentID] and c[componentID] and
+     * the soft constraints by their order in the objective, so getModel returns a Model of the problem.
+     * Rules cannot be added or removed, the file is solved as it is.
+     */
+    template<typename ID>
+    class ImportZ3 : public omtsched::Translator<ID> {
+    public:
+        /**
+         * @param path file written by Problem::print
+         * @param compress the file is gzipped, needs OMTSCHED_ZLIB
+         * @throws std::runtime_error if the file cannot be opened or read, compress is set without OMTSCHED_ZLIB
+         * or the names or the objective do not match the problem, z3::exception if it is no SMT-LIB
+         */
+        ImportZ3(const Problem<ID> &problem, const std::string &path, const bool &compress = false);
+
+        void solve() override;
+
+        /**
+         * @return the solver's answer, the first one is kept
+         */
+        z3::check_result resolve();
+
+        Model<ID> getModel() override;
+
+        bool isSAT() override;
+
+        z3::context &getContext();
+
+        /**
+         * @return number of slots, activations and components of the problem found in the file
+         */
+        size_t getMappedCount() const;
+
+    private:
+
+        void read(const std::string &path, const bool &compress);
+        void mapNames();
+
+        template<typename... Parts>
+        static std::string name(const Parts &... parts);
+
+        z3::context context;
+        z3::optimize optimizer;
+
+        std::map<std::pair<ID, ID>, z3::expr> slots;
+        std::map<ID, z3::expr> activations;
+        std::map<ID, std::vector<std::pair<ID, z3::expr>>> constants;
+
+        // the penalty terms of the objective in file order: soft rules by handle, then optional assignments
+        std::vector<std::pair<size_t, int>> softRules;
+        std::vector<z3::expr> softTerms;
+
+        std::optional<z3::check_result> result;
+        std::optional<Model<ID>> model;
+
+    };
+
+    template<typename ID>
+    ImportZ3<ID>::ImportZ3(const Problem<ID> &problem, const std::string &path, const bool &compress) : Translator<ID>{problem},
+    optimizer{context} {
+
+        read(path, compress);
+        mapNames();
+    }
+
+    template<typename ID>
+    void ImportZ3<ID>::read(const std::string &path, const bool &compress) {
+
+        if(!compress) {
+            optimizer.from_file(path.c_str());
+            return;
+        }
+
+#ifdef OMTSCHED_ZLIB
+        gzFile file = gzopen(path.c_str(), "rb");
+        if(!file)
+            throw std::runtime_error("could not open the input file " + path);
+
+        std::string text;
+        char chunk[1 << 16];
+        int n;
+        while((n = gzread(file, chunk, sizeof(chunk))) > 0)
+            text.append(chunk, (size_t) n);
+        gzclose(file);
+
+        // a truncated or corrupt file would otherwise be solved in part
+        if(n < 0)
+            throw std::runtime_error("could not read the input file " + path);
+
+        optimizer.from_string(text.c_str());
+#else
+        throw std::runtime_error("compressed input needs OMTSCHED_ZLIB");
+#endif
+    }
+
+    template<typename ID>
+    void ImportZ3<ID>::mapNames() {
+
+        const z3::expr_vector assertions = optimizer.assertions();
+        const z3::expr_vector objectives {context, Z3_optimize_get_objectives(context, optimizer)};
+        if(objectives.size() > 1)
+            throw std::runtime_error("the file has to be written by Problem::print");
+
+        // the uninterpreted constants, definitions of shared terms and rules are already expanded
+        std::unordered_map<std::string, z3::expr> named;
+        std::unordered_set<unsigned> visited;
+        std::vector<z3::expr> open;
+        for(unsigned i = 0; i < assertions.size(); i++)
+            open.push_back(assertions[i]);
+        for(unsigned i = 0; i < objectives.size(); i++)
+            open.push_back(objectives[i]);
+
+        while(!open.empty()) {
+
+            const z3::expr e = open.back();
+            open.pop_back();
+
+            if(!e.is_app() || !visited.insert(e.id()).second)
+                continue;
+
+            if(e.num_args() == 0 && e.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+                named.emplace(e.decl().name().str(), e);
+
+            for(unsigned i = 0; i < e.num_args(); i++)
+                open.push_back(e.arg(i));
+        }
+
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            if(asgn.isOptional()) {
+                auto it = named.find(name("act", aid));
+                if(it == named.end())
+                    throw std::runtime_error("optional assignment missing in the file");
+                activations.emplace(aid, it->second);
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                auto it = named.find(name("a", aid, "s", sid));
+                if(it == named.end())
+                    throw std::runtime_error("slot missing in the file");
+                slots.emplace(std::make_pair(aid, sid), it->second);
+            }
+        }
+
+        // components only appear if some slot can take them
+        for(const ID &type : this->problem.getComponentTypes())
+            for(const auto &component : this->problem.getComponents(type)) {
+                auto it = named.find(name("c", component->getID()));
+                if(it != named.end())
+                    constants[type].emplace_back(component->getID(), it->second);
+            }
+
+        // Problem::print lists the penalties in this order, each as (ite condition 0 weight)
+        const std::vector<Rule<ID>> &rules = this->problem.getRules();
+        for(size_t handle = 0; handle < rules.size(); handle++)
+            if(rules.at(handle).isOptional() && rules.at(handle).getWeight() != 0)
+                softRules.emplace_back(handle, rules.at(handle).getWeight());
+
+        if(!objectives.empty()) {
+            const z3::expr &sum = objectives[0];
+            // a single penalty is not wrapped in a sum
+            if(sum.decl().decl_kind() == Z3_OP_ITE)
+                softTerms.push_back(sum);
+            else
+                for(unsigned i = 0; i < sum.num_args(); i++)
+                    if(sum.arg(i).decl().decl_kind() == Z3_OP_ITE)
+                        softTerms.push_back(sum.arg(i));
+        }
+
+        size_t unfilled = 0;
+        for(const auto &[aid, asgn] : this->problem.getAssignments())
+            unfilled += asgn.isOptional() && asgn.getWeight() != 0;
+
+        if(softTerms.size() != softRules.size() + unfilled)
+            throw std::runtime_error("the objective does not match the problem");
+    }
+
+    template<typename ID>
+    template<typename... Parts>
+    std::string ImportZ3<ID>::name(const Parts &... parts) {
+
+        // the symbol as written by SmtWriter, Z3 drops the |...| quotes
+        std::ostringstream text;
+        (text << ... << parts);
+        return text.str();
+    }
+
+    template<typename ID>
+    z3::check_result ImportZ3<ID>::resolve() {
+
+        if(!result)
+            result = optimizer.check();
+
+        return *result;
+    }
+
+    template<typename ID>
+    void ImportZ3<ID>::solve() {
+
+        const auto answer = resolve();
+
+        if(answer == z3::unsat)
+            std::cout << "UNSAT" << std::endl;
+        else if(answer == z3::sat)
+            std::cout << "SAT" << std::endl;
+        else
+            std::cout << "UNKNOWN" << std::endl;
+    }
+
+    template<typename ID>
+    Model<ID> ImportZ3<ID>::getModel() {
+
+        if(resolve() != z3::sat)
+            return Model<ID>{};
+
+        if(model)
+            return *model;
+
+        const z3::model m = optimizer.get_model();
+        model.emplace();
+
+        // the component of every value of the model, per type
+        std::map<ID, std::unordered_map<unsigned, ID>> components;
+        for(const auto &[type, values] : constants)
+            for(const auto &[cid, constant] : values)
+                components[type].emplace(m.eval(constant, true).id(), cid);
+
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
+
+            if(activations.count(aid) && !m.eval(activations.at(aid), true).is_true()) {
+                model->addUnfilled(aid, asgn.getWeight());
+                continue;
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                const z3::expr value = m.eval(slots.at(std::make_pair(aid, sid)), true);
+                model->setComponent(aid, sid, components.at(slot.type).at(value.id()));
+            }
+        }
+
+        // a penalty term is its weight if the rule is violated and 0 otherwise
+        for(size_t i = 0; i < softRules.size(); i++)
+            if(!m.eval(softTerms.at(i) == 0, true).is_true())
+                model->addViolation(softRules.at(i).first, softRules.at(i).second);
+
+        return *model;
+    }
+
+    template<typename ID>
+    bool ImportZ3<ID>::isSAT() {
+        return resolve() == z3::sat;
+    }
+
+    template<typename ID>
+    z3::context &ImportZ3<ID>::getContext() {
+        return context;
+    }
+
+    template<typename ID>
+    size_t ImportZ3<ID>::getMappedCount() const {
+
+        size_t count = slots.size() + activations.size();
+        for(const auto &[type, values] : constants)
+            count += values.size();
+
+        return count;
+    }
+
+}
+
+#endif //OMTSCHED_IMPORTZ3_H
@@ -0,0 +1,83 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_OPTIONSZ3_H
+#define OMTSCHED_OPTIONSZ3_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace omtsched {
+
+    /*
+     * How the values of a component type are represented in Z3.
+     * ENUMERATION: one enumeration sort per type (default)
+     * BITVECTOR:   a bit-vector of ceil(log2(n)) bits per slot, components are numerals
+     * INTEGER:     a bounded integer per slot, ordered components use their value
+     * ONE_HOT:     one Boolean indicator per (slot, component)
+     */
+    enum class SORT_ENCODING {
+        ENUMERATION, BITVECTOR, INTEGER, ONE_HOT
+    };
+
+    template<typename ID>
+    struct OptionsZ3 {
+
+        SORT_ENCODING getEncoding(const ID &type) const;
+
+        void setEncoding(const ID &type, SORT_ENCODING encoding);
+
+        // used for all types that have no entry in typeEncodings
+        SORT_ENCODING defaultEncoding = SORT_ENCODING::ENUMERATION;
+        std::map<ID, SORT_ENCODING> typeEncodings;
+
+        // omit axioms implied by the sorts and restrict every slot to the components
+        // it can still take after fixed slots, InGroup rules and types are considered.
+        // Rules folded into the domains can no longer be removed or disabled, see TranslatorZ3::isDomainRule
+        bool minimalEncoding = false;
+
+        // use z3::optimize even if the problem has no soft rules, needed to add soft rules later
+        bool optimize = false;
+
+        // detect interchangeable components and assignments and keep only one representative
+        // of each symmetric solution, see TranslatorZ3::setSymmetryBreaking
+        bool symmetryBreaking = false;
+
+        // search configuration of the plain solver, varied between the members of a portfolio.
+        // z3::optimize does not take solver parameters, it ignores the three settings below
+        unsigned randomSeed = 0;
+
+        // tactics combined in this order into the solver, e.g. {"simplify", "solve-eqs", "bit-blast", "sat"},
+        // the default solver is used if empty
+        std::vector<std::string> tactics;
+
+        // further solver parameters, e.g. {"phase_selection", "5"} or {"sat.restart", "luby"},
+        // values are read as bool, unsigned, double or symbol in this order
+        std::map<std::string, std::string> parameters;
+
+        // tactics applied one by one to the goal before every check, e.g. {"simplify", "propagate-values",
+        // "solve-eqs", "elim-uncnstr"}; the resulting goal is solved by the tactics above or "smt".
+        // Each check starts from the full goal, assumptions become facts and there are no unsat cores
+        std::vector<std::string> preprocessing;
+    };
+
+    template<typename ID>
+    SORT_ENCODING OptionsZ3<ID>::getEncoding(const ID &type) const {
+
+        auto it = typeEncodings.find(type);
+        if(it == typeEncodings.end())
+            return defaultEncoding;
+
+        return it->second;
+    }
+
+    template<typename ID>
+    void OptionsZ3<ID>::setEncoding(const ID &type, SORT_ENCODING encoding) {
+        typeEncodings[type] = encoding;
+    }
+
+}
+
+#endif //OMTSCHED_OPTIONSZ3_H
@@ -0,0 +1,271 @@
+//
+// Created by hal on 19.10.26.
+//
+
+#ifndef OMTSCHED_PORTFOLIOZ3_H
+#define OMTSCHED_PORTFOLIOZ3_H
+
+#include "TranslatorZ3.h"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace omtsched {
+
+    /*
+     * Races several configurations of the Z3 translator against each other.
+     * Every configuration is grounded and solved on its own thread with its own context,
+     * the first one that answers sat or unsat wins and the others are interrupted.
+     */
+    template<typename ID>
+    class PortfolioZ3 : public omtsched::Translator<ID> {
+    public:
+        PortfolioZ3(const Problem<ID> &problem, std::vector<OptionsZ3<ID>> configurations);
+
+        /**
+         * Uses one diversified configuration per hardware thread.
+         */
+        explicit PortfolioZ3(const Problem<ID> &problem);
+
+        /**
+         * Derives configurations that differ in sort encoding, minimal encoding,
+         * random seed, tactic pipeline and SAT parameters.
+         * @param base options shared by all configurations, its typeEncodings are kept
+         */
+        static std::vector<OptionsZ3<ID>> diversify(const size_t &count, const OptionsZ3<ID> &base = {});
+
+        void solve() override;
+
+        /**
+         * Runs all configurations until the first definitive answer.
+         * @return unknown if every configuration gave up
+         * @throws the first exception of a configuration other than z3::exception if none answered,
+         * e.g. std::invalid_argument for a negative weight
+         */
+        z3::check_result race();
+
+        Model<ID> getModel() override;
+
+        bool isSAT() override;
+
+        /**
+         * @return index of the configuration that answered first, empty before race or if none answered
+         */
+        std::optional<size_t> getWinner() const;
+
+        /**
+         * @return the translator of the winning configuration, it stays usable for incremental solving
+         */
+        TranslatorZ3<ID> &getTranslator();
+
+    private:
+
+        const std::vector<OptionsZ3<ID>> configurations;
+
+        // only the winner is kept once the race is over
+        std::vector<std::unique_ptr<TranslatorZ3<ID>>> translators;
+        std::optional<size_t> winner;
+        z3::check_result result = z3::unknown;
+        bool raced = false;
+
+    };
+
+    template<typename ID>
+    PortfolioZ3<ID>::PortfolioZ3(const Problem<ID> &problem, std::vector<OptionsZ3<ID>> configurations) : Translator<ID>{problem},
+    configurations{std::move(configurations)} {
+
+        assert(!this->configurations.empty() && "a portfolio needs at least one configuration");
+    }
+
+    template<typename ID>
+    PortfolioZ3<ID>::PortfolioZ3(const Problem<ID> &problem) : PortfolioZ3{problem, diversify(std::max(1u, std::thread::hardware_concurrency()))} {}
+
+    template<typename ID>
+    std::vector<OptionsZ3<ID>> PortfolioZ3<ID>::diversify(const size_t &count, const OptionsZ3<ID> &base) {
+
+        const SORT_ENCODING encodings[] = {SORT_ENCODING::ENUMERATION, SORT_ENCODING::BITVECTOR,
+                                           SORT_ENCODING::ONE_HOT, SORT_ENCODING::INTEGER};
+
+        std::vector<OptionsZ3<ID>> configurations;
+        for(size_t i = 0; i < count; i++) {
+
+            OptionsZ3<ID> options = base;
+            options.randomSeed = base.randomSeed + i;
+
+            // the first configuration is the base itself
+            if(i == 0) {
+                configurations.push_back(options);
+                continue;
+            }
+
+            options.defaultEncoding = encodings[i % 4];
+            options.minimalEncoding = (i / 4) % 2 == 0 ? !base.minimalEncoding : base.minimalEncoding;
+
+            // every second round of encodings uses a dedicated pipeline, pure bit-vector
+            // and one-hot problems can be handed to the SAT solver directly
+            if((i / 4) % 2 == 1) {
+                const bool propositional = base.typeEncodings.empty() &&
+                        (options.defaultEncoding == SORT_ENCODING::BITVECTOR || options.defaultEncoding == SORT_ENCODING::ONE_HOT);
+
+                if(propositional) {
+                    options.tactics = {"simplify", "propagate-values", "solve-eqs", "card2bv", "bit-blast", "sat"};
+                    // the SAT tactic does not understand n-ary distinct
+                    options.parameters["blast_distinct"] = "true";
+                    options.parameters["sat.restart"] = i % 8 < 6 ? "luby" : "geometric";
+                    options.parameters["sat.phase"] = i % 2 ? "random" : "caching";
+                }
+                else {
+                    options.tactics = {"simplify", "propagate-values", "solve-eqs", "smt"};
+                    options.parameters["phase_selection"] = std::to_string(i % 7);
+                }
+            }
+            // otherwise only the phase heuristic of the default solver is varied
+            else if(i >= 4)
+                options.parameters["phase_selection"] = std::to_string(i % 7);
+
+            configurations.push_back(options);
+        }
+
+        return configurations;
+    }
+
+    template<typename ID>
+    z3::check_result PortfolioZ3<ID>::race() {
+
+        translators.clear();
+        translators.resize(configurations.size());
+        winner.reset();
+        result = z3::unknown;
+
+        std::mutex mutex;
+        std::condition_variable finishedOne;
+        size_t finished = 0;
+        // the first error other than Z3's, it would terminate the process if it left its thread
+        std::exception_ptr error;
+
+        std::vector<std::thread> threads;
+        threads.reserve(configurations.size());
+
+        for(size_t i = 0; i < configurations.size(); i++)
+            threads.emplace_back([&, i]() {
+
+                z3::check_result answer = z3::unknown;
+
+                // a configuration Z3 rejects (e.g. an unknown parameter) simply does not answer
+                try {
+                    auto translator = std::make_unique<TranslatorZ3<ID>>(this->problem, configurations.at(i));
+
+                    bool decided;
+                    {
+                        std::lock_guard<std::mutex> lock {mutex};
+                        // grounding cannot be interrupted, skip solving if the race is already decided
+                        decided = winner.has_value();
+                        if(!decided)
+                            translators.at(i) = std::move(translator);
+                    }
+
+                    if(!decided)
+                        answer = translators.at(i)->resolve();
+                }
+                catch(const z3::exception &) {
+                    answer = z3::unknown;
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> lock {mutex};
+                    if(!error)
+                        error = std::current_exception();
+                    answer = z3::unknown;
+                }
+
+                std::lock_guard<std::mutex> lock {mutex};
+                if(!winner && answer != z3::unknown) {
+                    winner = i;
+                    result = answer;
+                }
+                finished++;
+                finishedOne.notify_all();
+            });
+
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            finishedOne.wait(lock, [&]() { return winner || finished == threads.size(); });
+
+            // an interrupt can arrive before the check has started, so repeat it until everyone is done
+            while(finished < threads.size()) {
+                for(size_t i = 0; i < translators.size(); i++)
+                    if(translators.at(i) && winner != i)
+                        translators.at(i)->getContext().interrupt();
+                finishedOne.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+
+        for(std::thread &thread : threads)
+            thread.join();
+
+        for(size_t i = 0; i < translators.size(); i++)
+            if(winner != i)
+                translators.at(i).reset();
+
+        // e.g. a negative weight fails every configuration, one that answered is still a valid result
+        if(error && !winner)
+            std::rethrow_exception(error);
+
+        raced = true;
+        return result;
+    }
+
+    template<typename ID>
+    void PortfolioZ3<ID>::solve() {
+
+        const auto answer = race();
+
+        if (answer == z3::unsat)
+            std::cout << "UNSAT";
+        else if (answer == z3::sat)
+            std::cout << "SAT";
+        else
+            std::cout << "UNKNOWN";
+
+        if(winner)
+            std::cout << " (configuration " << *winner << ")";
+        std::cout << std::endl;
+    }
+
+    template<typename ID>
+    Model<ID> PortfolioZ3<ID>::getModel() {
+
+        if(!raced)
+            race();
+
+        if(!winner)
+            return Model<ID>{};
+
+        return getTranslator().getModel();
+    }
+
+    template<typename ID>
+    bool PortfolioZ3<ID>::isSAT() {
+
+        if(!raced)
+            race();
+
+        return result == z3::sat;
+    }
+
+    template<typename ID>
+    std::optional<size_t> PortfolioZ3<ID>::getWinner() const {
+        return winner;
+    }
+
+    template<typename ID>
+    TranslatorZ3<ID> &PortfolioZ3<ID>::getTranslator() {
+
+        assert(winner && "no configuration has answered");
+        return *translators.at(*winner);
+    }
+
+}
+
+#endif //OMTSCHED_PORTFOLIOZ3_H
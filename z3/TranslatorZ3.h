@@ -8,10 +8,20 @@
 
 #include "../Translator.h"
 #include "maps.h"
+#include "OptionsZ3.h"
 #include "../conditions/OrderedConditions.h"
 #include <z3.h>
 #include <z3++.h>
 #include <map>
+#include <optional>
+#include <unordered_map>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
 #include <boost/bimap.hpp>
 
 
@@ -20,7 +30,7 @@ namespace omtsched {
     template<typename ID>
     class TranslatorZ3 : public omtsched::Translator<ID> {
     public:
-        TranslatorZ3(const Problem <ID> &problem);
+        TranslatorZ3(const Problem <ID> &problem, const OptionsZ3<ID> &options = {});
 
         void solve() override;
 
@@ -36,6 +46,184 @@ namespace omtsched {
 
         void print() const;
 
+        // ------------------------- incremental solving -------------------------
+
+        /**
+         * Grounds a further rule into the existing solver.
+         * @return handle of the rule, used by removeRule
+         */
+        size_t addRule(std::shared_ptr<Condition<ID>> c);
+
+        /**
+         * Grounds a further hard or weighted soft rule into the existing solver.
+         * Soft rules can only be added if the translator optimizes, see OptionsZ3::optimize.
+         * @return handle of the rule, used by removeRule
+         * @throws std::logic_error for a soft rule if the translator does not optimize
+         * @throws std::invalid_argument for a soft rule with a negative weight
+         */
+        size_t addRule(std::shared_ptr<Condition<ID>> c, const bool &hard, const int &weight);
+
+        /**
+         * Retracts a rule, the problem's rules have the handles 0 to n-1 in the order they were added.
+         * @return false if the rule is unknown, already removed or (also partly) part of the slot domains,
+         * see isDomainRule
+         */
+        bool removeRule(const size_t &handle);
+
+        /**
+         * Opens a scope. Rules added in it are dropped and rules removed in it
+         * are restored by the matching pop.
+         */
+        void push();
+
+        void pop();
+
+        /**
+         * Checks the currently active rules with the existing solver,
+         * keeping everything Z3 has learned so far.
+         */
+        z3::check_result resolve();
+
+        /**
+         * Solves with a selection of rules, only by changing the assumptions.
+         * The selection stays in effect for resolve, isSAT and getModel until the next call,
+         * rules in neither set keep their state from addRule/removeRule.
+         * @param enabled handles of rules to enforce
+         * @param disabled handles of rules to ignore
+         * @throws std::invalid_argument if a handle is unknown, removed or part of the slot domains,
+         * which are enforced anyway
+         */
+        z3::check_result solve(const std::set<size_t> &enabled, const std::set<size_t> &disabled);
+
+        /**
+         * @return the tracking literal of a rule, usable in custom assumptions
+         * @throws std::invalid_argument if the rule is unknown or part of the slot domains, which have no guard
+         */
+        const z3::expr &getGuard(const size_t &handle) const;
+
+        /**
+         * With the minimal encoding, hard rules of the problem that restrict slots (InGroup, ComponentIs, and
+         * implications of them decided by fixed slots) are folded into the slot domains. They always hold:
+         * they cannot be removed, disabled or tracked by a guard. Turn off OptionsZ3::minimalEncoding to keep
+         * every rule retractable.
+         * @return true if the rule is wholly or partly part of the slot domains
+         */
+        bool isDomainRule(const size_t &handle) const;
+
+        /**
+         * @return the handles of the rules in the unsat core of the last unsatisfiable check
+         */
+        std::vector<size_t> getConflictingRules() const;
+
+        /**
+         * Explains why the active rules cannot hold together: a set of rules and fixed slots that is
+         * unsatisfiable on its own and, if marked minimal, no longer so without any one of its members.
+         * The unsat core is shrunk by deletion, testing several candidates at once on copies of the solver.
+         * With the minimal encoding fixed slots are part of the background and never explain anything.
+         * @param threads number of sub-checks run in parallel
+         * @return an empty explanation unless the current rules are unsatisfiable
+         */
+        Explanation<ID> explain(const size_t &threads = std::max(1u, std::thread::hardware_concurrency()));
+
+        // ------------------------- anytime optimization -------------------------
+
+        /*
+         * Limits of an anytime search, zero means unlimited.
+         * time:      wall-clock budget of the whole search
+         * resources: Z3 resource units (rlimit) of the whole search, deterministic across machines
+         */
+        struct Budget {
+            std::chrono::milliseconds time {0};
+            unsigned resources = 0;
+        };
+
+        /**
+         * Searches for models of decreasing penalty until the optimum is proven or the budget runs out.
+         * Respects the current rule selection like resolve.
+         * @param onIncumbent called with every improved model as soon as it is found
+         * @return the best model found (empty if none), with a lower bound if the search proved optimality
+         */
+        Model<ID> optimize(const Budget &budget, const std::function<void(const Model<ID> &)> &onIncumbent = {});
+
+        // ------------------------- symmetry breaking -------------------------
+
+        /**
+         * Switches the symmetry breaking constraints of OptionsZ3::symmetryBreaking on or off
+         * for the following checks, e.g. to enumerate all models instead of one per symmetry class.
+         * Adding a rule that names an interchangeable component switches it off for good,
+         * later calls cannot switch it on again (also not after a pop that drops the rule).
+         */
+        void setSymmetryBreaking(const bool &enabled);
+
+        bool isSymmetryBreaking() const;
+
+        /**
+         * @return classes of components that every rule treats alike by component type
+         */
+        const std::map<ID, std::vector<std::vector<ID>>> &getInterchangeableComponents() const;
+
+        /**
+         * @return classes of assignments with identical slots that every rule treats alike
+         */
+        const std::vector<std::vector<ID>> &getInterchangeableAssignments() const;
+
+        // ------------------------- enumeration -------------------------
+
+        /*
+         * Yields distinct models one at a time. After each model a clause over the slots
+         * (component and, for optional assignments, whether they are filled) excludes it,
+         * auxiliary variables are never blocked. Fixed slots cannot differ and are ignored.
+         * While symmetry breaking is switched on only one model per symmetry class is produced.
+         * The blocking clauses live in a scope of their own that is popped when the enumerator is destroyed.
+         */
+        class Enumerator {
+        public:
+            Enumerator(TranslatorZ3<ID> &translator, std::vector<std::pair<ID, ID>> projection, const size_t &limit);
+            Enumerator(Enumerator &&other) noexcept;
+            Enumerator(const Enumerator &) = delete;
+            ~Enumerator();
+
+            /**
+             * @return the next model, empty once all models (or the limit) have been produced
+             */
+            std::optional<Model<ID>> next();
+
+            size_t getCount() const;
+
+        private:
+            TranslatorZ3<ID> *translator;
+            const std::vector<std::pair<ID, ID>> projection;
+            const size_t limit;
+            size_t count = 0;
+            bool exhausted = false;
+        };
+
+        /**
+         * @param projection (assignment, slot) pairs two models have to differ in, all slots if empty
+         * @param limit maximum number of models, unlimited if 0
+         */
+        Enumerator enumerate(const std::vector<std::pair<ID, ID>> &projection = {}, const size_t &limit = 0);
+
+        // ------------------------- preprocessing -------------------------
+
+        /*
+         * One step of the preprocessing pipeline (see OptionsZ3::preprocessing), the last step is the solving tactic.
+         * Sizes are summed over all subgoals: formulas is the number of assertions, size the number of subterms.
+         */
+        struct TacticStatistics {
+            std::string tactic;
+            std::chrono::microseconds time;
+            unsigned formulasBefore, formulasAfter;
+            unsigned sizeBefore, sizeAfter;
+        };
+
+        /**
+         * @return the steps of the last preprocessed check in order
+         */
+        const std::vector<TacticStatistics> &getTacticStatistics() const;
+
+        void printTacticStatistics(std::ostream &ostr) const;
+
     private:
 
         void setupVariables();
@@ -43,10 +231,31 @@ namespace omtsched {
         void setupUniqueness();
         void setupExistence();
         void setupFixed();
+        void setupDomains();
+        void setupSolver();
+
+        // minimal encoding: static reasoning over fixed slots
+        std::optional<bool> evaluateFixed(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> &asgn) const;
+        bool isRestriction(const std::shared_ptr<Condition<ID>> &condition) const;
+        void restrictDomain(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> &asgn);
+        z3::expr restrictTo(const ID &assignment, const ID &componentSlot, const std::vector<bool> &domain);
 
         //std::vector<std::vector<Assignment<ID> *>> generateAllAsgn(const Rule<ID> &rule);
 
-        void resolveRule(const Rule <ID> &rule);
+        void resolveRule(const size_t &handle, const bool &inDomains);
+
+        // symmetry breaking: value precedence for interchangeable components,
+        // ordered activation and first slot for interchangeable assignments
+        void setupSymmetryBreaking();
+        void findInterchangeableComponents();
+        void findInterchangeableAssignments();
+        void collectComponents(const std::shared_ptr<Condition<ID>> &condition, std::set<ID> &components) const;
+        bool containsType(const std::shared_ptr<Condition<ID>> &condition, const CONDITION_TYPE &type) const;
+        bool breaksSymmetry(const std::shared_ptr<Condition<ID>> &condition) const;
+        std::vector<ID> getValueOrder(const ID &type) const;
+        z3::expr isAtMost(const ID &assignment1, const ID &assignment2, const ID &componentSlot);
+
+        z3::expr_vector getAssumptions();
 
         void addToSolver(const z3::expr &condition, const bool &hard, const int &weight);
 
@@ -54,50 +263,206 @@ namespace omtsched {
         const z3::expr &getVariable(const ID &assignment, const ID &componentSlot) const;
         const z3::expr &getConstant(const ID &component) const;
 
+        // encoding independent atoms
+        z3::expr isComponent(const ID &assignment, const ID &componentSlot, const ID &component) const;
+        z3::expr isSameComponent(const ID &assignment1, const ID &assignment2, const ID &componentSlot);
+        z3::expr isDistinct(const std::vector<ID> &assignments, const ID &componentSlot);
+        z3::expr isInDomain(const ID &assignment, const ID &componentSlot);
+
+        // optional assignments: only constrained while their activation literal holds
+        z3::expr isActive(const ID &assignment);
+        z3::expr ifActive(const ID &assignment, const z3::expr &constraint);
+        void setupActivation();
+
+        // interpretations of the slot variables, indicators and activations of a model, read in one pass.
+        // Their declarations are created one after another, so they are indexed by declaration id - declBase
+        using Interpretations = std::vector<Z3_ast>;
+        Interpretations getInterpretations(const z3::model &m) const;
+        z3::expr getValue(const z3::model &m, const Interpretations &values, const z3::expr &e) const;
+
+        const ID getComponent(const z3::model &m, const Interpretations &values, const ID &assignment, const ID &componentSlot) const;
+
+        // per slot the type and the variable, or the indicators of a one-hot slot
+        struct SlotReader {
+            size_t type;
+            bool oneHot;
+            std::vector<z3::expr> exprs;
+        };
+
+        // per assignment in the order of the problem, so that extracting a model needs no search
+        struct AssignmentReader {
+            std::optional<z3::expr> activation;
+            std::vector<SlotReader> slots;
+        };
+
+        void setupExtraction();
+        const ID &readComponent(const z3::model &m, const Interpretations &values, const SlotReader &reader) const;
+
+        std::vector<AssignmentReader> readers;
+        unsigned declBase = 0;
+        size_t declCount = 0;
+
 
         z3::expr resolveCondition(const std::shared_ptr<Condition <ID>> &condition, const Assignment<ID>* asgn = nullptr);
         z3::expr resolveComponentIs(const std::shared_ptr<Condition <ID>> &, const Assignment<ID> *asgn);
         //z3::expr resolveComponentIn(const std::shared_ptr<Condition <ID> &, const std::vector<Assignment<ID>*> &asgnComb);
         z3::expr resolveSameComponent(const std::shared_ptr<Condition <ID>> &,const std::vector<Assignment<ID>*> &asgnComb = {});
-        z3::expr resolveInGroup(const std::shared_ptr<Condition <ID>> &, const std::vector<Assignment<ID>*> &asgnComb = {});
+        z3::expr resolveInGroup(const std::shared_ptr<Condition <ID>> &, const Assignment<ID> *asgn);
+        z3::expr resolveImplies(const std::shared_ptr<Condition <ID>> &, const bool &topLevel = false);
         //z3::expr resolveMaxAssignments(const std::shared_ptr<Condition <ID> &, const std::vector<Assignment<ID>*> &asgnComb);
         z3::expr resolveDistinct(const std::shared_ptr<Condition <ID>> &);
         z3::expr resolveBlocked(const std::shared_ptr<Condition <ID>> &);
         z3::expr resolveGreater(const std::shared_ptr<Condition <ID>> &condition);
 
         const Problem<ID> &problem;
+        const OptionsZ3<ID> options;
 
         z3::context context;
         std::unique_ptr<z3::solver> solver;
+        // used instead of the solver as soon as there are soft rules
+        std::unique_ptr<z3::optimize> optimizer;
 
         SortMap<ID> sorts;
         //ComponentMap<ID> components;
         SlotMap<ID> slots;
+
+        // allowed component ordinals per slot, only used with minimal encoding
+        std::map<std::pair<ID, ID>, std::vector<bool>> domains;
+        // handles of the rules that are wholly or partly in the domains
+        std::set<size_t> domainRules;
+
+        // the problem's rules followed by those added later, indexed by handle
+        std::vector<Rule<ID>> rules;
+        // every rule is asserted as guard => rule and the guards of active rules are assumed
+        std::map<size_t, z3::expr> guards;
+        std::map<unsigned, size_t> guardHandles;
+        // fixed slots are asserted as guard => slot holds component and the guards are always assumed
+        std::map<std::pair<ID, ID>, z3::expr> fixedGuards;
+        std::map<unsigned, std::pair<ID, ID>> fixedHandles;
+
+        std::map<ID, std::vector<std::vector<ID>>> interchangeableComponents;
+        std::vector<std::vector<ID>> interchangeableAssignments;
+        // assumed while symmetry breaking is switched on
+        std::optional<z3::expr> symmetryGuard;
+        bool symmetryBreaking = false;
+        // a rule added later broke the detected symmetries, the constraints would prune models
+        bool symmetryInvalidated = false;
+        std::set<size_t> activeRules;
+
+        // selection of the last solve(enabled, disabled)
+        std::set<size_t> enabledRules;
+        std::set<size_t> disabledRules;
+
+        struct Scope {
+            size_t ruleCount;
+            std::set<size_t> activeRules;
+        };
+        std::vector<Scope> scopes;
         
         //std::vector<z3::func_decl_vector> enum_consts;
         //std::vector<z3::func_decl_vector> enum_testers;
         
         void addToSolver(const z3::expr &);
 
+        z3::check_result check(const z3::expr_vector &assumptions);
+        z3::model getZ3Model() const;
+
+        // the last check is answered again as long as neither assertions nor assumptions change
+        void invalidate();
+        std::optional<z3::check_result> lastResult;
+        std::vector<unsigned> lastAssumptions;
+        std::optional<Model<ID>> lastModel;
+        z3::expr_vector getUnsatCore() const;
+
+        Model<ID> extractModel(const z3::model &m);
+
+        z3::expr blockingClause(const z3::model &m, const std::vector<std::pair<ID, ID>> &projection);
+
+        z3::check_result checkPreprocessed(const z3::expr_vector &assumptions);
+
+        std::vector<TacticStatistics> tacticStatistics;
+        // model of the last preprocessed check, converted back to the original variables
+        std::optional<z3::model> preprocessedModel;
+
+        // expressions of the soft rules, evaluated to report violations
+        std::map<size_t, z3::expr> softRules;
+
+        // activation literals of optional assignments
+        std::map<ID, z3::expr> activations;
+
     };
 
     template<typename ID>
-    TranslatorZ3<ID>::TranslatorZ3(const Problem <ID> &problem) : Translator<ID>{problem}, problem{problem},
-    sorts{context, problem}, slots{context, problem, sorts} {
-
-        
-        solver = std::make_unique<z3::solver>(context);
+    TranslatorZ3<ID>::TranslatorZ3(const Problem <ID> &problem, const OptionsZ3<ID> &options) : Translator<ID>{problem}, problem{problem},
+    options{options}, sorts{context, problem, options}, slots{context, problem, sorts}, rules{problem.getRules()} {
+
+        bool soft = options.optimize;
+        for(const Rule<ID> &rule : rules)
+            soft = soft || rule.isOptional();
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            soft = soft || (asgn.isOptional() && asgn.getWeight() != 0);
+
+        if(soft)
+            optimizer = std::make_unique<z3::optimize>(context);
+        else
+            setupSolver();
+
+        setupActivation();
+        setupExtraction();
         
-        setupExistence();
-        setupUniqueness();
-        setupFixed();
+        if(options.minimalEncoding)
+            setupDomains();
+        else {
+            setupExistence();
+            setupUniqueness();
+            setupFixed();
+        }
         
-        for(const Rule<ID> &rule : problem.getRules())
-            resolveRule(rule);
+        for(size_t handle = 0; handle < rules.size(); handle++)
+            resolveRule(handle, true);
+
+        if(options.symmetryBreaking)
+            setupSymmetryBreaking();
         
     }
 
 
+    template<typename ID>
+    void TranslatorZ3<ID>::setupSolver() {
+
+        if(options.tactics.empty())
+            solver = std::make_unique<z3::solver>(context);
+        else {
+            z3::tactic pipeline {context, options.tactics.front().c_str()};
+            for(auto it = std::next(options.tactics.begin()); it != options.tactics.end(); it++)
+                pipeline = pipeline & z3::tactic(context, it->c_str());
+            solver = std::make_unique<z3::solver>(pipeline.mk_solver());
+        }
+
+        z3::params params {context};
+        params.set("random_seed", options.randomSeed);
+
+        for(const auto &[name, value] : options.parameters) {
+
+            char *end = nullptr;
+            const unsigned long number = std::strtoul(value.c_str(), &end, 10);
+            const bool isUnsigned = !value.empty() && value.front() != '-' && *end == '\0';
+            const double real = std::strtod(value.c_str(), &end);
+            const bool isDouble = !value.empty() && *end == '\0';
+
+            if(value == "true" || value == "false")
+                params.set(name.c_str(), value == "true");
+            else if(isUnsigned)
+                params.set(name.c_str(), (unsigned) number);
+            else if(isDouble)
+                params.set(name.c_str(), real);
+            else
+                params.set(name.c_str(), context.str_symbol(value.c_str()));
+        }
+
+        solver->set(params);
+    }
+
     template<typename ID>
     z3::context &TranslatorZ3<ID>::getContext() {
         return context;
@@ -105,8 +470,268 @@ namespace omtsched {
     
     template<typename ID>
     void TranslatorZ3<ID>::addToSolver(const z3::expr &constraint) {
-    
-            solver->add(constraint);
+
+            invalidate();
+
+            if(optimizer)
+                optimizer->add(constraint);
+            else
+                solver->add(constraint);
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::addToSolver(const z3::expr &condition, const bool &hard, const int &weight) {
+
+        if(hard) {
+            addToSolver(condition);
+            return;
+        }
+
+        if(!optimizer)
+            throw std::logic_error("soft constraints need OptionsZ3::optimize or soft rules in the problem");
+        if(weight < 0)
+            throw std::invalid_argument("weights of soft constraints cannot be negative");
+
+        invalidate();
+        optimizer->add_soft(condition, (unsigned) weight);
+    }
+
+    template<typename ID>
+    z3::check_result TranslatorZ3<ID>::check(const z3::expr_vector &assumptions) {
+
+        std::vector<unsigned> ids;
+        ids.reserve(assumptions.size());
+        for(const z3::expr &assumption : assumptions)
+            ids.push_back(assumption.id());
+
+        // model and unsat core of the solver still belong to this check
+        if(lastResult && ids == lastAssumptions)
+            return *lastResult;
+
+        invalidate();
+
+        z3::check_result result;
+        if(optimizer)
+            result = optimizer->check(assumptions);
+        else if(!options.preprocessing.empty())
+            result = checkPreprocessed(assumptions);
+        else
+            result = solver->check(assumptions);
+
+        // an interrupted or timed out check may well succeed when repeated
+        if(result != z3::unknown) {
+            lastResult = result;
+            lastAssumptions = std::move(ids);
+        }
+
+        return result;
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::invalidate() {
+
+        lastResult.reset();
+        lastModel.reset();
+    }
+
+    template<typename ID>
+    TranslatorZ3<ID>::Enumerator::Enumerator(TranslatorZ3<ID> &translator, std::vector<std::pair<ID, ID>> projection, const size_t &limit) :
+    translator{&translator}, projection{std::move(projection)}, limit{limit} {
+
+        translator.push();
+    }
+
+    template<typename ID>
+    TranslatorZ3<ID>::Enumerator::Enumerator(Enumerator &&other) noexcept : translator{other.translator},
+    projection{other.projection}, limit{other.limit}, count{other.count}, exhausted{other.exhausted} {
+
+        // the scope now belongs to this enumerator
+        other.translator = nullptr;
+    }
+
+    template<typename ID>
+    TranslatorZ3<ID>::Enumerator::~Enumerator() {
+
+        if(translator)
+            translator->pop();
+    }
+
+    template<typename ID>
+    std::optional<Model<ID>> TranslatorZ3<ID>::Enumerator::next() {
+
+        if(!translator || exhausted || (limit != 0 && count >= limit))
+            return std::nullopt;
+
+        if(translator->check(translator->getAssumptions()) != z3::sat) {
+            exhausted = true;
+            return std::nullopt;
+        }
+
+        const z3::model m = translator->getZ3Model();
+        const z3::expr block = translator->blockingClause(m, projection);
+
+        // nothing left that could differ
+        if(block.is_false())
+            exhausted = true;
+        else
+            translator->addToSolver(block);
+
+        count++;
+        return translator->extractModel(m);
+    }
+
+    template<typename ID>
+    size_t TranslatorZ3<ID>::Enumerator::getCount() const {
+        return count;
+    }
+
+    template<typename ID>
+    typename TranslatorZ3<ID>::Enumerator TranslatorZ3<ID>::enumerate(const std::vector<std::pair<ID, ID>> &projection, const size_t &limit) {
+        return Enumerator{*this, projection, limit};
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::blockingClause(const z3::model &m, const std::vector<std::pair<ID, ID>> &projection) {
+
+        std::vector<std::pair<ID, ID>> blocked = projection;
+        if(blocked.empty())
+            for(const auto &[aid, asgn] : problem.getAssignments())
+                for(const auto &[sid, slot] : asgn.getComponentSlots())
+                    blocked.emplace_back(aid, sid);
+
+        z3::expr_vector differences {context};
+        std::set<ID> activationBlocked;
+        const Interpretations values = getInterpretations(m);
+
+        for(const auto &[aid, sid] : blocked) {
+
+            const auto &slot = problem.getAssignment(aid).getSlot(sid);
+
+            // an optional assignment differs if it is filled in one model and unfilled in the other
+            if(activations.count(aid)) {
+                const bool active = getValue(m, values, activations.at(aid)).is_true();
+                if(activationBlocked.insert(aid).second)
+                    differences.push_back(active ? !activations.at(aid) : activations.at(aid));
+                if(!active)
+                    continue;
+            }
+
+            if(!slot.fixed)
+                differences.push_back(!isComponent(aid, sid, getComponent(m, values, aid, sid)));
+        }
+
+        return z3::mk_or(differences);
+    }
+
+    template<typename ID>
+    z3::check_result TranslatorZ3<ID>::checkPreprocessed(const z3::expr_vector &assumptions) {
+
+        using clock = std::chrono::steady_clock;
+
+        tacticStatistics.clear();
+        preprocessedModel.reset();
+
+        z3::goal goal {context};
+        goal.add(solver->assertions());
+        goal.add(assumptions);
+
+        // the solving tactic is the last step, only then does the goal carry
+        // the model conversions of all steps before it
+        std::vector<std::string> steps = options.preprocessing;
+        steps.push_back("");
+
+        std::vector<z3::goal> goals {goal};
+
+        for(const std::string &step : steps) {
+
+            z3::tactic tactic {context, step.empty() ? "smt" : step.c_str()};
+            if(step.empty() && !options.tactics.empty()) {
+                tactic = z3::tactic(context, options.tactics.front().c_str());
+                for(auto it = std::next(options.tactics.begin()); it != options.tactics.end(); it++)
+                    tactic = tactic & z3::tactic(context, it->c_str());
+            }
+
+            TacticStatistics statistics {step.empty() ? "solve" : step, {}, 0, 0, 0, 0};
+            std::vector<z3::goal> results;
+
+            const auto start = clock::now();
+            for(const z3::goal &current : goals) {
+
+                statistics.formulasBefore += current.size();
+                statistics.sizeBefore += current.num_exprs();
+
+                // a tactic that does not apply to the goal (e.g. sat on arithmetic) gives no answer
+                try {
+                    const z3::apply_result result = tactic(current);
+                    for(unsigned i = 0; i < result.size(); i++)
+                        results.push_back(result[i]);
+                }
+                catch(const z3::exception &) {
+                    tacticStatistics.push_back(statistics);
+                    return z3::unknown;
+                }
+            }
+            statistics.time = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start);
+
+            for(const z3::goal &result : results) {
+                statistics.formulasAfter += result.size();
+                statistics.sizeAfter += result.num_exprs();
+            }
+
+            tacticStatistics.push_back(statistics);
+            goals = std::move(results);
+        }
+
+        // the subgoals are alternatives, one satisfiable subgoal suffices
+        bool unsat = true;
+        for(const z3::goal &result : goals) {
+            if(result.is_decided_sat()) {
+                preprocessedModel = result.convert_model(z3::model(context));
+                return z3::sat;
+            }
+            unsat = unsat && result.is_decided_unsat();
+        }
+
+        return unsat ? z3::unsat : z3::unknown;
+    }
+
+    template<typename ID>
+    const std::vector<typename TranslatorZ3<ID>::TacticStatistics> &TranslatorZ3<ID>::getTacticStatistics() const {
+        return tacticStatistics;
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::printTacticStatistics(std::ostream &ostr) const {
+
+        for(const TacticStatistics &step : tacticStatistics)
+            ostr << step.tactic << "\t" << step.time.count() << "us"
+                 << "\tformulas " << step.formulasBefore << " -> " << step.formulasAfter
+                 << "\tsize " << step.sizeBefore << " -> " << step.sizeAfter << std::endl;
+    }
+
+    template<typename ID>
+    z3::model TranslatorZ3<ID>::getZ3Model() const {
+
+        if(optimizer)
+            return optimizer->get_model();
+
+        if(preprocessedModel)
+            return *preprocessedModel;
+
+        return solver->get_model();
+    }
+
+    template<typename ID>
+    z3::expr_vector TranslatorZ3<ID>::getUnsatCore() const {
+
+        if(optimizer)
+            return optimizer->unsat_core();
+
+        // assumptions are facts of the preprocessed goal
+        if(!options.preprocessing.empty())
+            return z3::expr_vector {solver->ctx()};
+
+        return solver->unsat_core();
     }
 
     /*
@@ -118,66 +743,696 @@ namespace omtsched {
     }*/
 
     template<typename ID>
-    const z3::expr &TranslatorZ3<ID>::getVariable(const ID &assignment, const ID &componentSlot) const {
-        return slots.getVariable(assignment, componentSlot);
+    const z3::expr &TranslatorZ3<ID>::getVariable(const ID &assignment, const ID &componentSlot) const {
+        return slots.getVariable(assignment, componentSlot);
+    }
+
+    template<typename ID>
+    const z3::expr &TranslatorZ3<ID>::getConstant(const ID &component) const {
+        return sorts.getConstant(component);
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isComponent(const ID &assignment, const ID &componentSlot, const ID &component) const {
+
+        const ID &type = problem.getAssignment(assignment).getSlot(componentSlot).type;
+
+        if(sorts.getEncoding(type) == SORT_ENCODING::ONE_HOT)
+            return slots.getIndicators(assignment, componentSlot)[sorts.getOrdinal(component)];
+
+        return getVariable(assignment, componentSlot) == getConstant(component);
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isSameComponent(const ID &assignment1, const ID &assignment2, const ID &componentSlot) {
+
+        const ID &type = problem.getAssignment(assignment1).getSlot(componentSlot).type;
+
+        if(sorts.getEncoding(type) != SORT_ENCODING::ONE_HOT)
+            return getVariable(assignment1, componentSlot) == getVariable(assignment2, componentSlot);
+
+        // exactly one indicator is set per slot, so it suffices that the indicators agree
+        const z3::expr_vector &first = slots.getIndicators(assignment1, componentSlot);
+        const z3::expr_vector &second = slots.getIndicators(assignment2, componentSlot);
+
+        z3::expr_vector equalities {context};
+        for(unsigned i = 0; i < first.size(); i++)
+            equalities.push_back(first[i] == second[i]);
+
+        return z3::mk_and(equalities);
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isDistinct(const std::vector<ID> &assignments, const ID &componentSlot) {
+
+        if(assignments.empty())
+            return context.bool_val(true);
+
+        const ID &type = problem.getAssignment(assignments.front()).getSlot(componentSlot).type;
+
+        if(sorts.getEncoding(type) != SORT_ENCODING::ONE_HOT) {
+
+            z3::expr_vector constraints {context};
+            z3::expr_vector vars {context};
+            std::vector<ID> optional;
+
+            for(const ID &asgn : assignments) {
+                if(activations.count(asgn))
+                    optional.push_back(asgn);
+                else
+                    vars.push_back(getVariable(asgn, componentSlot));
+            }
+
+            if(vars.size() > 1)
+                constraints.push_back(z3::distinct(vars));
+
+            // optional assignments only conflict with others while they are active
+            for(auto it = optional.begin(); it != optional.end(); it++)
+                for(const ID &other : assignments)
+                    if(other != *it && (!activations.count(other) || other > *it))
+                        constraints.push_back(z3::implies(isActive(*it) && isActive(other),
+                                                          getVariable(*it, componentSlot) != getVariable(other, componentSlot)));
+
+            return z3::mk_and(constraints);
+        }
+
+        // every component is used by at most one of the active slots
+        z3::expr_vector atMostOnce {context};
+        for(size_t i = 0; i < sorts.getSize(type); i++) {
+            z3::expr_vector users {context};
+            for(const ID &asgn : assignments)
+                users.push_back(activations.count(asgn) ? slots.getIndicators(asgn, componentSlot)[i] && isActive(asgn)
+                                                        : slots.getIndicators(asgn, componentSlot)[i]);
+            atMostOnce.push_back(z3::atmost(users, 1));
+        }
+
+        return z3::mk_and(atMostOnce);
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isInDomain(const ID &assignment, const ID &componentSlot) {
+
+        const ID &type = problem.getAssignment(assignment).getSlot(componentSlot).type;
+        const size_t size = sorts.getSize(type);
+
+        switch (sorts.getEncoding(type)) {
+
+            case SORT_ENCODING::ONE_HOT: {
+                const z3::expr_vector &indicators = slots.getIndicators(assignment, componentSlot);
+                return z3::atleast(indicators, 1) && z3::atmost(indicators, 1);
+            }
+
+            case SORT_ENCODING::BITVECTOR: {
+                const z3::expr &var = getVariable(assignment, componentSlot);
+                if(size == 0)
+                    return context.bool_val(false);
+                return z3::ule(var, context.bv_val(uint64_t{size - 1}, var.get_sort().bv_size()));
+            }
+
+            case SORT_ENCODING::INTEGER: {
+                // contiguous values (always the case if ordinals are used) form a range
+                const z3::expr &var = getVariable(assignment, componentSlot);
+                std::vector<int64_t> values;
+                for(const auto &comp : problem.getComponents(type))
+                    values.push_back(getConstant(comp->getID()).get_numeral_int64());
+                std::sort(values.begin(), values.end());
+                if(!values.empty() && values.back() - values.front() + 1 == (int64_t) values.size())
+                    return var >= context.int_val(values.front()) && var <= context.int_val(values.back());
+            }
+            [[fallthrough]];
+
+            default: {
+                // enumeration sorts: one of the component constants
+                z3::expr_vector potentialValues {context};
+                for(const auto &comp : problem.getComponents(type))
+                    potentialValues.push_back(isComponent(assignment, componentSlot, comp->getID()));
+                return z3::mk_or(potentialValues);
+            }
+        }
+    }
+
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isActive(const ID &assignment) {
+
+        auto it = activations.find(assignment);
+        if(it == activations.end())
+            return context.bool_val(true);
+
+        return it->second;
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::ifActive(const ID &assignment, const z3::expr &constraint) {
+
+        auto it = activations.find(assignment);
+        if(it == activations.end())
+            return constraint;
+
+        return z3::implies(it->second, constraint);
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupActivation() {
+
+        int a = 0;
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            if(asgn.isOptional()) {
+                z3::expr active = context.bool_const(("act" + std::to_string(a)).c_str());
+                activations.emplace(aid, active);
+
+                // leaving the assignment unfilled costs its weight
+                if(asgn.getWeight() != 0)
+                    addToSolver(active, false, asgn.getWeight());
+            }
+            a++;
+        }
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupExtraction() {
+
+        std::vector<unsigned> ids;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            AssignmentReader reader;
+            if(activations.count(aid)) {
+                reader.activation = activations.at(aid);
+                ids.push_back(activations.at(aid).decl().id());
+            }
+
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                SlotReader slotReader {sorts.getTypeIndex(slot.type), sorts.getEncoding(slot.type) == SORT_ENCODING::ONE_HOT, {}};
+
+                if(slotReader.oneHot)
+                    for(const z3::expr &indicator : slots.getIndicators(aid, sid))
+                        slotReader.exprs.push_back(indicator);
+                else
+                    slotReader.exprs.push_back(slots.getVariable(aid, sid));
+
+                for(const z3::expr &e : slotReader.exprs)
+                    ids.push_back(e.decl().id());
+
+                reader.slots.push_back(std::move(slotReader));
+            }
+
+            readers.push_back(std::move(reader));
+        }
+
+        if(!ids.empty()) {
+            declBase = *std::min_element(ids.begin(), ids.end());
+            declCount = *std::max_element(ids.begin(), ids.end()) - declBase + 1;
+        }
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupExistence(){
+        
+        //Every assignment slot variable needs to have a value
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+
+                // TODO: optional slots
+                // fixed slots keep their value, even if the assignment stays unfilled
+                addToSolver(slot.fixed ? isInDomain(aid, sid) : ifActive(aid, isInDomain(aid, sid)));
+            }
+                
+        }
+        
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupUniqueness(){
+
+        for(const auto &type : this->problem.getComponentTypes()){
+
+            // numerals are distinct by construction, one-hot types have no constants
+            if(sorts.getEncoding(type) != SORT_ENCODING::ENUMERATION)
+                continue;
+
+            z3::expr_vector vars {context};
+            for(const auto &component : this->problem.getComponents(type))
+                vars.push_back(getConstant(component->getID()));
+
+            if(!vars.empty()) {
+                z3::expr dis = z3::distinct(vars);
+                addToSolver(dis);
+            }
+        }
+
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupFixed() {
+
+        int a = 0;
+        for(const auto &[ida, asgn] : problem.getAssignments()) {
+            // numbered like the other internal literals, IDs need not be text
+            int k = 0;
+            for(const auto &[ids, slot] : asgn.getComponentSlots())
+                if(slot.fixed){
+                    // tracked, so that explanations can name the fixed slots involved
+                    z3::expr guard = context.bool_const(("fa" + std::to_string(a) + "_" + std::to_string(k++)).c_str());
+                    fixedGuards.emplace(std::make_pair(ida, ids), guard);
+                    fixedHandles.emplace(guard.id(), std::make_pair(ida, ids));
+
+                    z3::expr eq = isComponent(ida, ids, slot.component);
+                    addToSolver(z3::implies(guard, eq));
+                }
+            a++;
+        }
+
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupDomains() {
+
+        // start from the full type, fixed slots only keep their component
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+                std::vector<bool> domain(sorts.getSize(slot.type), !slot.fixed);
+                if(slot.fixed)
+                    domain.at(sorts.getOrdinal(slot.component)) = true;
+                domains.emplace(std::make_pair(aid, sid), std::move(domain));
+            }
+
+        // InGroup and ComponentIs rules, either on their own or as consequents
+        // of implications that are decided by fixed slots
+        for(size_t handle = 0; handle < rules.size(); handle++) {
+
+            const Rule<ID> &rule = rules.at(handle);
+
+            // soft rules may be violated
+            if(rule.isOptional())
+                continue;
+
+            const auto &c = rule.getTopCondition();
+
+            for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+                if(isRestriction(c)) {
+                    restrictDomain(c, asgn);
+                    domainRules.insert(handle);
+                }
+
+                else if(c->getType() == CONDITION_TYPE::IMPLIES && isRestriction(c->subconditions.at(1))
+                    && evaluateFixed(c->subconditions.at(0), asgn) == std::optional<bool>{true}) {
+                    restrictDomain(c->subconditions.at(1), asgn);
+                    domainRules.insert(handle);
+                }
+            }
+        }
+
+        for(const auto &[slot, domain] : domains) {
+            const bool fixed = problem.getAssignment(slot.first).getSlot(slot.second).fixed;
+            addToSolver(fixed ? restrictTo(slot.first, slot.second, domain)
+                              : ifActive(slot.first, restrictTo(slot.first, slot.second, domain)));
+        }
+
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setupSymmetryBreaking() {
+
+        findInterchangeableComponents();
+        findInterchangeableAssignments();
+
+        symmetryGuard = context.bool_const("sym");
+        symmetryBreaking = true;
+
+        z3::expr_vector constraints {context};
+
+        // value precedence: within a class, a component may only be used by a slot
+        // if the one before it in the value order is used by an earlier slot
+        int classCount = 0;
+        for(const auto &[type, classes] : interchangeableComponents) {
+
+            std::vector<std::pair<ID, ID>> sequence;
+            for(const auto &[aid, asgn] : problem.getAssignments())
+                for(const auto &[sid, slot] : asgn.getComponentSlots())
+                    if(!slot.fixed && slot.type == type)
+                        sequence.emplace_back(aid, sid);
+
+            const std::vector<ID> order = getValueOrder(type);
+
+            for(const std::vector<ID> &interchangeable : classes) {
+
+                std::vector<ID> values;
+                for(const ID &component : order)
+                    if(std::find(interchangeable.begin(), interchangeable.end(), component) != interchangeable.end())
+                        values.push_back(component);
+
+                // seen[j] holds if values[j] is used by one of the slots so far
+                std::vector<z3::expr> seen(values.size(), context.bool_val(false));
+
+                for(size_t p = 0; p < sequence.size(); p++) {
+
+                    const auto &[aid, sid] = sequence.at(p);
+
+                    std::vector<z3::expr> occurs;
+                    for(const ID &value : values)
+                        occurs.push_back(isActive(aid) && isComponent(aid, sid, value));
+
+                    for(size_t j = 1; j < values.size(); j++)
+                        constraints.push_back(z3::implies(occurs.at(j), seen.at(j - 1)));
+
+                    // auxiliary literals keep the prefixes from growing with the sequence
+                    for(size_t j = 0; j + 1 < values.size(); j++) {
+                        z3::expr next = context.bool_const(("sym" + std::to_string(classCount) + "_" + std::to_string(j)
+                                                            + "_" + std::to_string(p)).c_str());
+                        constraints.push_back(next == (seen.at(j) || occurs.at(j)));
+                        seen.at(j) = next;
+                    }
+                }
+                classCount++;
+            }
+        }
+
+        // interchangeable assignments: filled ones first, then ascending in their first variable slot.
+        // Renaming components must not reorder them, so only slots without interchangeable components count
+        for(const std::vector<ID> &interchangeable : interchangeableAssignments) {
+
+            std::optional<ID> first;
+            for(const auto &[sid, slot] : problem.getAssignment(interchangeable.front()).getComponentSlots())
+                if(!slot.fixed && !interchangeableComponents.count(slot.type)) {
+                    first = sid;
+                    break;
+                }
+
+            for(size_t i = 0; i + 1 < interchangeable.size(); i++) {
+
+                const ID &current = interchangeable.at(i);
+                const ID &next = interchangeable.at(i + 1);
+
+                if(activations.count(current))
+                    constraints.push_back(z3::implies(isActive(next), isActive(current)));
+
+                if(first)
+                    constraints.push_back(z3::implies(isActive(current) && isActive(next), isAtMost(current, next, *first)));
+            }
+        }
+
+        if(!constraints.empty())
+            addToSolver(z3::implies(*symmetryGuard, z3::mk_and(constraints)));
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::findInterchangeableComponents() {
+
+        // components named by a rule or a fixed slot are distinguished
+        std::set<ID> distinguished;
+        for(const Rule<ID> &rule : rules)
+            collectComponents(rule.getTopCondition(), distinguished);
+        for(const auto &[aid, asgn] : problem.getAssignments())
+            for(const auto &[sid, slot] : asgn.getComponentSlots())
+                if(slot.fixed)
+                    distinguished.insert(slot.component);
+
+        for(const ID &type : problem.getComponentTypes()) {
+
+            // everything else is interchangeable with the components that share its groups and tags
+            std::map<std::pair<std::set<ID>, std::map<ID, int>>, std::vector<ID>> classes;
+            for(const auto &component : problem.getComponents(type))
+                if(!distinguished.count(component->getID()))
+                    classes[std::make_pair(component->getGroups(), component->getTags())].push_back(component->getID());
+
+            for(auto &[signature, components] : classes)
+                if(components.size() > 1)
+                    interchangeableComponents[type].push_back(std::move(components));
+        }
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::findInterchangeableAssignments() {
+
+        // Blocked orders assignments with equal slots by their ID
+        for(const Rule<ID> &rule : rules)
+            if(containsType(rule.getTopCondition(), CONDITION_TYPE::BLOCKED))
+                return;
+
+        // slot name, type, fixed component (if any) of every slot, optionality and weight
+        using Signature = std::pair<std::vector<std::tuple<ID, ID, std::optional<ID>>>, std::pair<bool, int>>;
+        std::map<Signature, std::vector<ID>> classes;
+
+        for(const auto &[aid, asgn] : problem.getAssignments()) {
+
+            Signature signature {{}, {asgn.isOptional(), asgn.isOptional() ? asgn.getWeight() : 0}};
+            for(const auto &[sid, slot] : asgn.getComponentSlots())
+                signature.first.emplace_back(sid, slot.type, slot.fixed ? std::optional<ID>{slot.component} : std::nullopt);
+
+            classes[signature].push_back(aid);
+        }
+
+        for(auto &[signature, assignments] : classes)
+            if(assignments.size() > 1)
+                interchangeableAssignments.push_back(std::move(assignments));
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::collectComponents(const std::shared_ptr<Condition<ID>> &condition, std::set<ID> &components) const {
+
+        if(condition->getType() == CONDITION_TYPE::COMPONENT_IS)
+            components.insert(std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->component);
+
+        for(const auto &sub : condition->subconditions)
+            collectComponents(sub, components);
+    }
+
+    template<typename ID>
+    bool TranslatorZ3<ID>::containsType(const std::shared_ptr<Condition<ID>> &condition, const CONDITION_TYPE &type) const {
+
+        if(condition->getType() == type)
+            return true;
+
+        for(const auto &sub : condition->subconditions)
+            if(containsType(sub, type))
+                return true;
+
+        return false;
+    }
+
+    template<typename ID>
+    bool TranslatorZ3<ID>::breaksSymmetry(const std::shared_ptr<Condition<ID>> &condition) const {
+
+        if(!interchangeableAssignments.empty() && containsType(condition, CONDITION_TYPE::BLOCKED))
+            return true;
+
+        std::set<ID> named;
+        collectComponents(condition, named);
+
+        for(const auto &[type, classes] : interchangeableComponents)
+            for(const std::vector<ID> &interchangeable : classes)
+                for(const ID &component : interchangeable)
+                    if(named.count(component))
+                        return true;
+
+        return false;
+    }
+
+    template<typename ID>
+    std::vector<ID> TranslatorZ3<ID>::getValueOrder(const ID &type) const {
+
+        // the order in which isAtMost compares: integers by value, everything else by ordinal
+        std::vector<ID> order;
+        for(const auto &component : problem.getComponents(type))
+            order.push_back(component->getID());
+
+        if(sorts.getEncoding(type) == SORT_ENCODING::INTEGER)
+            std::stable_sort(order.begin(), order.end(), [this](const ID &lhs, const ID &rhs) {
+                return getConstant(lhs).get_numeral_int64() < getConstant(rhs).get_numeral_int64();
+            });
+
+        return order;
+    }
+
+    template<typename ID>
+    z3::expr TranslatorZ3<ID>::isAtMost(const ID &assignment1, const ID &assignment2, const ID &componentSlot) {
+
+        const ID &type = problem.getAssignment(assignment1).getSlot(componentSlot).type;
+
+        switch (sorts.getEncoding(type)) {
+
+            case SORT_ENCODING::BITVECTOR:
+                return z3::ule(getVariable(assignment1, componentSlot), getVariable(assignment2, componentSlot));
+
+            case SORT_ENCODING::INTEGER:
+                return getVariable(assignment1, componentSlot) <= getVariable(assignment2, componentSlot);
+
+            default: {
+                // no order on the sort: the second slot holds none of the components before the first one's
+                const std::vector<ID> order = getValueOrder(type);
+                z3::expr_vector constraints {context};
+                z3::expr_vector smaller {context};
+
+                for(const ID &component : order) {
+                    if(!smaller.empty())
+                        constraints.push_back(z3::implies(isComponent(assignment1, componentSlot, component), !z3::mk_or(smaller)));
+                    smaller.push_back(isComponent(assignment2, componentSlot, component));
+                }
+
+                return z3::mk_and(constraints);
+            }
+        }
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::setSymmetryBreaking(const bool &enabled) {
+        symmetryBreaking = enabled && symmetryGuard && !symmetryInvalidated;
     }
 
     template<typename ID>
-    const z3::expr &TranslatorZ3<ID>::getConstant(const ID &component) const {
-        return sorts.getConstant(component);
+    bool TranslatorZ3<ID>::isSymmetryBreaking() const {
+        return symmetryBreaking;
     }
 
+    template<typename ID>
+    const std::map<ID, std::vector<std::vector<ID>>> &TranslatorZ3<ID>::getInterchangeableComponents() const {
+        return interchangeableComponents;
+    }
 
     template<typename ID>
-    void TranslatorZ3<ID>::setupExistence(){
-        
-        //Every assignment slot variable needs to have a value
-        for(const auto &[aid, asgn] : problem.getAssignments()) {
-            for(const auto &[sid, slot] : asgn.getComponentSlots()) {
+    const std::vector<std::vector<ID>> &TranslatorZ3<ID>::getInterchangeableAssignments() const {
+        return interchangeableAssignments;
+    }
 
-                z3::expr_vector potentialValues {context};
-                // TODO: optional slots
-                // TODO: slots with limited set of potential values
-                const z3::expr &slotVariable = getVariable(aid, sid);
-                for(const auto &comp : problem.getComponents(slot.type)){
-                    const z3::expr &component = getConstant(comp->getID());
-                    z3::expr eqls {slotVariable == component};
-                    potentialValues.push_back(eqls);
+    template<typename ID>
+    std::optional<bool> TranslatorZ3<ID>::evaluateFixed(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> &asgn) const {
+
+        switch (condition->getType()) {
+
+            case CONDITION_TYPE::NOT: {
+                auto sub = evaluateFixed(condition->subconditions.at(0), asgn);
+                if(sub)
+                    return !*sub;
+                return std::nullopt;
+            }
+
+            case CONDITION_TYPE::AND:
+            case CONDITION_TYPE::OR: {
+                // the value that decides the whole condition
+                const bool decisive = condition->getType() == CONDITION_TYPE::OR;
+                bool known = true;
+                for(const auto &sub : condition->subconditions) {
+                    auto value = evaluateFixed(sub, asgn);
+                    if(value == std::optional<bool>{decisive})
+                        return decisive;
+                    known = known && value;
                 }
-                solver->add( z3::mk_or(potentialValues));
+                if(known)
+                    return !decisive;
+                return std::nullopt;
             }
-                
+
+            case CONDITION_TYPE::COMPONENT_IS: {
+                auto c = std::dynamic_pointer_cast<ComponentIs<ID>>(condition);
+                auto it = asgn.getComponentSlots().find(c->componentSlot);
+                if(it == asgn.getComponentSlots().end() || !it->second.fixed)
+                    return std::nullopt;
+                return it->second.component == c->component;
+            }
+
+            case CONDITION_TYPE::IN_GROUP: {
+                auto c = std::dynamic_pointer_cast<InGroup<ID>>(condition);
+                auto it = asgn.getComponentSlots().find(c->slot);
+                if(it == asgn.getComponentSlots().end() || !it->second.fixed)
+                    return std::nullopt;
+                const auto &slot = it->second;
+                return problem.getComponents(slot.type).at(sorts.getOrdinal(slot.component))->inGroup(c->group);
+            }
+
+            default:
+                return std::nullopt;
         }
-        
     }
 
     template<typename ID>
-    void TranslatorZ3<ID>::setupUniqueness(){
+    bool TranslatorZ3<ID>::isRestriction(const std::shared_ptr<Condition<ID>> &condition) const {
 
-        for(const auto &type : this->problem.getComponentTypes()){
+        switch (condition->getType()) {
 
-            z3::expr_vector vars {context};
-            for(const auto &component : this->problem.getComponents(type))
-                vars.push_back(getConstant(component->getID()));
+            case CONDITION_TYPE::COMPONENT_IS:
+            case CONDITION_TYPE::IN_GROUP:
+                return true;
 
-            if(!vars.empty()) {
-                z3::expr dis = z3::distinct(vars);
-                solver->add(dis);
-            }
+            case CONDITION_TYPE::AND:
+                for(const auto &sub : condition->subconditions)
+                    if(!isRestriction(sub))
+                        return false;
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::restrictDomain(const std::shared_ptr<Condition<ID>> &condition, const Assignment<ID> &asgn) {
+
+        if(condition->getType() == CONDITION_TYPE::AND) {
+            for(const auto &sub : condition->subconditions)
+                restrictDomain(sub, asgn);
+            return;
         }
 
+        const ID &slotID = condition->getType() == CONDITION_TYPE::IN_GROUP ?
+                std::dynamic_pointer_cast<InGroup<ID>>(condition)->slot :
+                std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->componentSlot;
+
+        auto it = asgn.getComponentSlots().find(slotID);
+        if(it == asgn.getComponentSlots().end())
+            return;
+
+        std::vector<bool> &domain = domains.at(std::make_pair(asgn.getID(), slotID));
+        const auto &components = problem.getComponents(it->second.type);
+
+        for(size_t i = 0; i < domain.size(); i++) {
+
+            if(condition->getType() == CONDITION_TYPE::IN_GROUP) {
+                if(!components.at(i)->inGroup(std::dynamic_pointer_cast<InGroup<ID>>(condition)->group))
+                    domain.at(i) = false;
+            }
+            else if(components.at(i)->getID() != std::dynamic_pointer_cast<ComponentIs<ID>>(condition)->component)
+                domain.at(i) = false;
+        }
     }
 
     template<typename ID>
-    void TranslatorZ3<ID>::setupFixed() {
+    z3::expr TranslatorZ3<ID>::restrictTo(const ID &assignment, const ID &componentSlot, const std::vector<bool> &domain) {
 
-        for(const auto &[ida, asgn] : problem.getAssignments())
-            for(const auto &[ids, slot] : asgn.getComponentSlots())
-                if(slot.fixed){
-                    z3::expr eq = getVariable(ida, ids) == getConstant(slot.component);
-                    solver->add(eq);
-                }
+        const ID &type = problem.getAssignment(assignment).getSlot(componentSlot).type;
+        const SORT_ENCODING encoding = sorts.getEncoding(type);
+        const auto &components = problem.getComponents(type);
+
+        std::vector<ID> allowed, excluded;
+        for(size_t i = 0; i < domain.size(); i++)
+            (domain.at(i) ? allowed : excluded).push_back(components.at(i)->getID());
+
+        // the sort itself already limits enumerations and full-width bit-vectors
+        z3::expr base = context.bool_val(true);
+        if(encoding == SORT_ENCODING::BITVECTOR) {
+            if(domain.size() != (size_t{1} << getVariable(assignment, componentSlot).get_sort().bv_size()))
+                base = isInDomain(assignment, componentSlot);
+        }
+        else if(encoding != SORT_ENCODING::ENUMERATION)
+            base = isInDomain(assignment, componentSlot);
+
+        // assert whichever of the allowed or excluded values is shorter
+        if(encoding != SORT_ENCODING::ONE_HOT && allowed.size() <= excluded.size()) {
+            z3::expr_vector potentialValues {context};
+            for(const ID &component : allowed)
+                potentialValues.push_back(isComponent(assignment, componentSlot, component));
+            return z3::mk_or(potentialValues);
+        }
+
+        z3::expr_vector restrictions {context};
+        restrictions.push_back(base);
+        for(const ID &component : excluded)
+            restrictions.push_back(!isComponent(assignment, componentSlot, component));
 
+        return z3::mk_and(restrictions);
     }
 
     template<typename ID>
@@ -229,18 +1484,319 @@ namespace omtsched {
 
     }
 
+    template<typename ID>
+    z3::expr_vector TranslatorZ3<ID>::getAssumptions() {
+
+        z3::expr_vector assumptions {context};
+        // soft rules are not assumed, their guards are weighted in the objective instead
+        for(const size_t &handle : activeRules)
+            if(!enabledRules.count(handle) && !disabledRules.count(handle) && !softRules.count(handle))
+                assumptions.push_back(guards.at(handle));
+
+        for(const size_t &handle : enabledRules)
+            if(!softRules.count(handle))
+                assumptions.push_back(guards.at(handle));
+
+        for(const size_t &handle : disabledRules)
+            assumptions.push_back(!guards.at(handle));
+
+        for(const auto &[slot, guard] : fixedGuards)
+            assumptions.push_back(guard);
+
+        if(symmetryGuard && symmetryBreaking && !symmetryInvalidated)
+            assumptions.push_back(*symmetryGuard);
+
+        return assumptions;
+    }
+
+    template<typename ID>
+    Explanation<ID> TranslatorZ3<ID>::explain(const size_t &threads) {
+
+        Explanation<ID> explanation;
+
+        const z3::expr_vector assumptions = getAssumptions();
+        if(check(assumptions) != z3::unsat)
+            return explanation;
+
+        std::set<unsigned> inCore;
+        for(const z3::expr &literal : getUnsatCore())
+            inCore.insert(literal.id());
+
+        // tracked literals of the core, or all of them if there is no core (preprocessing);
+        // the remaining assumptions (negated guards of disabled rules) stay in the background
+        z3::expr_vector literals {context};
+        z3::expr_vector background {context};
+        for(const z3::expr &literal : assumptions) {
+            if(!guardHandles.count(literal.id()) && !fixedHandles.count(literal.id()))
+                background.push_back(literal);
+            else if(inCore.empty() || inCore.count(literal.id()))
+                literals.push_back(literal);
+        }
+
+        // every worker checks on its own context, everything is translated up front
+        // because the main context must not be touched from several threads
+        struct Worker {
+            z3::context context;
+            std::unique_ptr<z3::solver> solver;
+            std::unique_ptr<z3::expr_vector> literals;
+            std::unique_ptr<z3::expr_vector> background;
+            std::map<unsigned, size_t> indices;
+        };
+
+        const z3::expr_vector hard = optimizer ? optimizer->assertions() : solver->assertions();
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for(size_t w = 0; w < std::max<size_t>(1, threads); w++) {
+            auto worker = std::make_unique<Worker>();
+            worker->solver = std::make_unique<z3::solver>(worker->context);
+            worker->solver->add(z3::expr_vector(worker->context, hard));
+            worker->literals = std::make_unique<z3::expr_vector>(worker->context, literals);
+            worker->background = std::make_unique<z3::expr_vector>(worker->context, background);
+            for(unsigned i = 0; i < worker->literals->size(); i++)
+                worker->indices.emplace((*worker->literals)[i].id(), i);
+            workers.push_back(std::move(worker));
+        }
+
+        // deletion: a literal whose removal makes the rest satisfiable is needed in every
+        // smaller core as well, otherwise the core of the sub-check replaces the current one
+        std::vector<size_t> current(literals.size());
+        for(size_t i = 0; i < current.size(); i++)
+            current.at(i) = i;
+
+        std::set<size_t> critical;
+        bool minimal = true;
+
+        while(true) {
+
+            std::vector<size_t> candidates;
+            for(const size_t &i : current)
+                if(!critical.count(i) && candidates.size() < workers.size())
+                    candidates.push_back(i);
+
+            if(candidates.empty())
+                break;
+
+            std::vector<z3::check_result> results(candidates.size(), z3::unknown);
+            std::vector<std::vector<size_t>> cores(candidates.size());
+            std::vector<std::thread> running;
+
+            for(size_t c = 0; c < candidates.size(); c++)
+                running.emplace_back([&, c]() {
+
+                    Worker &worker = *workers.at(c);
+                    z3::expr_vector subset {worker.context};
+                    for(const z3::expr &literal : *worker.background)
+                        subset.push_back(literal);
+                    for(const size_t &i : current)
+                        if(i != candidates.at(c))
+                            subset.push_back((*worker.literals)[i]);
+
+                    results.at(c) = worker.solver->check(subset);
+
+                    if(results.at(c) == z3::unsat)
+                        for(const z3::expr &literal : worker.solver->unsat_core()) {
+                            auto it = worker.indices.find(literal.id());
+                            if(it != worker.indices.end())
+                                cores.at(c).push_back(it->second);
+                        }
+                });
+
+            for(std::thread &thread : running)
+                thread.join();
+
+            std::optional<size_t> smallest;
+            for(size_t c = 0; c < candidates.size(); c++) {
+
+                if(results.at(c) == z3::unsat) {
+                    if(!smallest || cores.at(c).size() < cores.at(*smallest).size())
+                        smallest = c;
+                    continue;
+                }
+
+                // without an answer the candidate is kept, but minimality is no longer guaranteed
+                if(results.at(c) == z3::unknown)
+                    minimal = false;
+                critical.insert(candidates.at(c));
+            }
+
+            if(smallest) {
+                current = cores.at(*smallest);
+                std::sort(current.begin(), current.end());
+            }
+        }
+
+        for(const size_t &i : current) {
+
+            const z3::expr &literal = literals[i];
+
+            auto rule = guardHandles.find(literal.id());
+            if(rule != guardHandles.end())
+                explanation.addRule(rule->second, rules.at(rule->second));
+            else {
+                const auto &[aid, sid] = fixedHandles.at(literal.id());
+                explanation.addFixedSlot(aid, sid, problem.getAssignment(aid).getSlot(sid).component);
+            }
+        }
+
+        explanation.setMinimal(minimal);
+        return explanation;
+    }
+
+    template<typename ID>
+    z3::check_result TranslatorZ3<ID>::solve(const std::set<size_t> &enabled, const std::set<size_t> &disabled) {
+
+        // removed rules have no clauses left and the domains cannot be switched, checked before the selection changes
+        for(const std::set<size_t> *selection : {&enabled, &disabled})
+            for(const size_t &handle : *selection)
+                if(!activeRules.count(handle) || domainRules.count(handle))
+                    throw std::invalid_argument("rule " + std::to_string(handle) + " is unknown, removed or part of the slot domains");
+
+        enabledRules.clear();
+        disabledRules = disabled;
+
+        for(const size_t &handle : enabled)
+            if(!disabled.count(handle))
+                enabledRules.insert(handle);
+
+        return resolve();
+    }
+
+    template<typename ID>
+    const z3::expr &TranslatorZ3<ID>::getGuard(const size_t &handle) const {
+
+        // the guard of a partly absorbed rule would not switch off its part in the domains
+        if(domainRules.count(handle) || !guards.count(handle))
+            throw std::invalid_argument("rule " + std::to_string(handle) + " is unknown or part of the slot domains");
+
+        return guards.at(handle);
+    }
+
+    template<typename ID>
+    bool TranslatorZ3<ID>::isDomainRule(const size_t &handle) const {
+        return domainRules.count(handle);
+    }
+
+    template<typename ID>
+    std::vector<size_t> TranslatorZ3<ID>::getConflictingRules() const {
+
+        std::vector<size_t> conflicting;
+        for(const z3::expr &literal : getUnsatCore()) {
+            auto it = guardHandles.find(literal.id());
+            if(it != guardHandles.end())
+                conflicting.push_back(it->second);
+        }
+
+        std::sort(conflicting.begin(), conflicting.end());
+        return conflicting;
+    }
+
+    template<typename ID>
+    z3::check_result TranslatorZ3<ID>::resolve() {
+        return check(getAssumptions());
+    }
+
+    template<typename ID>
+    size_t TranslatorZ3<ID>::addRule(std::shared_ptr<Condition<ID>> c) {
+
+        rules.emplace_back(std::move(c), false, 0);
+        resolveRule(rules.size() - 1, false);
+
+        return rules.size() - 1;
+    }
+
+    template<typename ID>
+    size_t TranslatorZ3<ID>::addRule(std::shared_ptr<Condition<ID>> c, const bool &hard, const int &weight) {
+
+        // checked before the rule is grounded, so that a rejected rule leaves no trace
+        if(!hard && !optimizer)
+            throw std::logic_error("soft rules can only be added if the translator optimizes, see OptionsZ3::optimize");
+        if(!hard && weight < 0)
+            throw std::invalid_argument("weights of soft rules cannot be negative");
+
+        rules.emplace_back(std::move(c), !hard, weight);
+        resolveRule(rules.size() - 1, false);
+
+        return rules.size() - 1;
+    }
+
+    template<typename ID>
+    bool TranslatorZ3<ID>::removeRule(const size_t &handle) {
+
+        // the part in the domains would stay, so the rule is kept as a whole
+        if(domainRules.count(handle) || !activeRules.erase(handle))
+            return false;
+
+        enabledRules.erase(handle);
+
+        // lets the solver drop the rule's clauses, undone by pop like every other assertion
+        addToSolver(!guards.at(handle));
+        return true;
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::push() {
+
+        invalidate();
+
+        if(optimizer)
+            optimizer->push();
+        else
+            solver->push();
+        scopes.push_back({rules.size(), activeRules});
+    }
+
+    template<typename ID>
+    void TranslatorZ3<ID>::pop() {
+
+        if(scopes.empty())
+            return;
+
+        invalidate();
+
+        if(optimizer)
+            optimizer->pop();
+        else
+            solver->pop();
+
+        const Scope &scope = scopes.back();
+        rules.erase(rules.begin() + scope.ruleCount, rules.end());
+        for(auto it = guards.lower_bound(scope.ruleCount); it != guards.end(); it = guards.erase(it))
+            guardHandles.erase(it->second.id());
+        softRules.erase(softRules.lower_bound(scope.ruleCount), softRules.end());
+        activeRules = scope.activeRules;
+
+        // selected rules that no longer exist
+        enabledRules.erase(enabledRules.lower_bound(scope.ruleCount), enabledRules.end());
+        disabledRules.erase(disabledRules.lower_bound(scope.ruleCount), disabledRules.end());
+
+        scopes.pop_back();
+    }
+
     template<typename ID>
     void TranslatorZ3<ID>::solve() {
 
-        const auto result = solver->check();
+        if(this->isGenerateAllSolution()) {
+
+            Enumerator solutions = enumerate();
+            while(const std::optional<Model<ID>> model = solutions.next())
+                model->print(std::cout);
 
-        if (result == z3::unsat)
+            std::cout << solutions.getCount() << " SOLUTIONS" << std::endl;
+            return;
+        }
+
+        const auto result = resolve();
+
+        if (result == z3::unsat) {
             std::cout << "UNSAT" << std::endl;
 
+            if(this->isGenerateExplanations())
+                explain().print(std::cout);
+        }
+
         else if (result == z3::sat) {
 
             std::cout << "SAT" << std::endl;
-            z3::model m = solver->get_model();
         } else if (result == z3::unknown)
             std::cout << "UNKNOWN" << std::endl;
 
@@ -250,27 +1806,134 @@ namespace omtsched {
     template<typename ID>
     Model<ID> TranslatorZ3<ID>::getModel() {
 
-        Model<ID> model;
+        if(resolve() != z3::sat)
+            return Model<ID>{};
+
+        if(!lastModel)
+            lastModel = extractModel(getZ3Model());
+
+        return *lastModel;
+    }
 
-        if(!solver->check() == z3::sat)
-            return model;
+    template<typename ID>
+    Model<ID> TranslatorZ3<ID>::extractModel(const z3::model &m) {
 
-        z3::model m = solver->get_model();
+        Model<ID> model;
+        const Interpretations values = getInterpretations(m);
 
-        for(const auto &[aid, asgn] : this->problem.getAssignments())
-            for(const auto &[sid, slot] : asgn.getComponentSlots()){
+        auto reader = readers.begin();
+        for(const auto &[aid, asgn] : this->problem.getAssignments()) {
 
-                const z3::expr &var = getVariable(aid, sid);
-                const z3::expr &result = m.eval(var);
+            const AssignmentReader &assignment = *reader++;
 
-                const ID &component = getComponent(result);
-                model.setComponent(aid, sid, component);
+            if(assignment.activation && !getValue(m, values, *assignment.activation).is_true()) {
+                model.addUnfilled(aid, asgn.getWeight());
+                continue;
             }
 
+            auto slot = assignment.slots.begin();
+            for(const auto &[sid, s] : asgn.getComponentSlots())
+                model.setComponent(aid, sid, readComponent(m, values, *slot++));
+        }
+
+        // soft rules that are switched on but not satisfied
+        for(const auto &[handle, expr] : softRules)
+            if(activeRules.count(handle) && !disabledRules.count(handle) && m.eval(expr, true).is_false())
+                model.addViolation(handle, rules.at(handle).getWeight());
+
         return model;
 
     }
 
+    template<typename ID>
+    Model<ID> TranslatorZ3<ID>::optimize(const Budget &budget, const std::function<void(const Model<ID> &)> &onIncumbent) {
+
+        using clock = std::chrono::steady_clock;
+        const auto deadline = clock::now() + budget.time;
+
+        // linear search on a plain solver: every incumbent turns its penalty into a bound,
+        // so unlike z3::optimize there is a model to report whenever the budget runs out
+        z3::solver search {context};
+        search.add(optimizer ? optimizer->assertions() : solver->assertions());
+
+        // the objective: violated soft rules and unfilled optional assignments
+        z3::expr_vector penalties {context};
+        std::vector<int> weights;
+
+        for(const auto &[handle, expr] : softRules)
+            if(activeRules.count(handle) && !disabledRules.count(handle) && rules.at(handle).getWeight() != 0) {
+                penalties.push_back(!guards.at(handle));
+                weights.push_back(rules.at(handle).getWeight());
+            }
+
+        for(const auto &[aid, active] : activations)
+            if(problem.getAssignment(aid).getWeight() != 0) {
+                penalties.push_back(!active);
+                weights.push_back(problem.getAssignment(aid).getWeight());
+            }
+
+        const z3::expr_vector assumptions = getAssumptions();
+        const auto resourcesUsed = [&search]() {
+            const z3::stats statistics = search.statistics();
+            for(unsigned i = 0; i < statistics.size(); i++)
+                if(statistics.key(i) == "rlimit count")
+                    return statistics.uint_value(i);
+            return 0u;
+        };
+
+        Model<ID> best;
+        bool found = false;
+        const unsigned startResources = resourcesUsed();
+
+        while(true) {
+
+            z3::params params {context};
+
+            if(budget.time.count() > 0) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now()).count();
+                if(remaining <= 0)
+                    break;
+                params.set("timeout", (unsigned) remaining);
+            }
+
+            if(budget.resources > 0) {
+                const unsigned used = resourcesUsed() - startResources;
+                if(used >= budget.resources)
+                    break;
+                params.set("rlimit", budget.resources - used);
+            }
+
+            search.set(params);
+            const z3::check_result result = search.check(assumptions);
+
+            // the last bound cannot be met, the incumbent is optimal
+            if(result == z3::unsat) {
+                if(found)
+                    best.setLowerBound(best.getPenalty());
+                break;
+            }
+
+            // budget exhausted
+            if(result == z3::unknown)
+                break;
+
+            best = extractModel(search.get_model());
+            found = true;
+
+            if(onIncumbent)
+                onIncumbent(best);
+
+            if(best.getPenalty() == 0 || penalties.empty()) {
+                best.setLowerBound(best.getPenalty());
+                break;
+            }
+
+            search.add(z3::pble(penalties, weights.data(), best.getPenalty() - 1));
+        }
+
+        return best;
+    }
+
    template<typename ID>
    z3::expr TranslatorZ3<ID>::resolveCondition(const std::shared_ptr<Condition <ID>> &condition, const Assignment<ID>* asgn) {
 
@@ -298,14 +1961,8 @@ namespace omtsched {
                return (resolveCondition(condition->subconditions.at(0), asgn) && !resolveCondition(condition->subconditions.at(1), asgn))
                || (!resolveCondition(condition->subconditions.at(0), asgn) && resolveCondition(condition->subconditions.at(1), asgn));
 
-           case CONDITION_TYPE::IMPLIES:{
-
-               for(auto &[id, asgn] : problem.getAssignments()){
-                   z3args.push_back(z3::implies(resolveCondition(condition->subconditions.at(0), &asgn),
-                                                resolveCondition(condition->subconditions.at(1), &asgn)));
-               }
-               return z3::mk_and(z3args);
-           }
+           case CONDITION_TYPE::IMPLIES:
+               return resolveImplies(condition);
 
            case CONDITION_TYPE::IFF:
                return z3::implies(resolveCondition(condition->subconditions.at(0), asgn), resolveCondition(condition->subconditions.at(1), asgn))
@@ -321,7 +1978,7 @@ namespace omtsched {
                return resolveSameComponent(condition);
 
            case CONDITION_TYPE::IN_GROUP:
-               return resolveInGroup(condition);
+               return resolveInGroup(condition, asgn);
 
            case CONDITION_TYPE::DISTINCT:
                return resolveDistinct(condition);
@@ -351,12 +2008,36 @@ namespace omtsched {
    }
 
    template<typename ID>
-   void TranslatorZ3<ID>::resolveRule(const Rule <ID> &rule) {
+   void TranslatorZ3<ID>::resolveRule(const size_t &handle, const bool &inDomains) {
+
+       const auto &c = rules.at(handle).getTopCondition();
+       const bool inDomain = inDomains && !rules.at(handle).isOptional();
 
-       const auto &c = rule.getTopCondition();
+       // the symmetries were detected for the rules known at that time
+       if(symmetryGuard && breaksSymmetry(c)) {
+           symmetryBreaking = false;
+           symmetryInvalidated = true;
+       }
+
+       // already part of the slot domains, cannot be removed
+       if(options.minimalEncoding && inDomain && isRestriction(c))
+           return;
+
+       z3::expr e = options.minimalEncoding && c->getType() == CONDITION_TYPE::IMPLIES ?
+               resolveImplies(c, inDomain) : resolveCondition(c);
+
+       z3::expr guard = context.bool_const(("r" + std::to_string(handle)).c_str());
+       guards.emplace(handle, guard);
+       guardHandles.emplace(guard.id(), handle);
+       activeRules.insert(handle);
 
-       z3::expr e = resolveCondition(c);
-       addToSolver(e);
+       addToSolver(z3::implies(guard, e));
+
+       // violating a soft rule costs its weight
+       if(rules.at(handle).isOptional()) {
+           softRules.emplace(handle, e);
+           addToSolver(guard, false, rules.at(handle).getWeight());
+       }
 
         /*
        std::vector<std::vector<Assignment<ID> *>> appSets = rule.getApplicableSets();
@@ -371,10 +2052,42 @@ namespace omtsched {
    }
 
 
+   template<typename ID>
+   z3::expr TranslatorZ3<ID>::resolveImplies(const std::shared_ptr<Condition <ID>> &condition, const bool &topLevel) {
+
+       const auto &antecedent = condition->subconditions.at(0);
+       const auto &consequent = condition->subconditions.at(1);
+
+       z3::expr_vector z3args{context};
+       for(auto &[id, asgn] : problem.getAssignments()){
+
+           if(options.minimalEncoding) {
+
+               const std::optional<bool> value = evaluateFixed(antecedent, asgn);
+
+               // vacuous instance
+               if(value == std::optional<bool>{false})
+                   continue;
+
+               if(value) {
+                   // top level restrictions have been moved into the slot domains
+                   if(!(topLevel && isRestriction(consequent)))
+                       z3args.push_back(ifActive(id, resolveCondition(consequent, &asgn)));
+                   continue;
+               }
+           }
+
+           z3args.push_back(ifActive(id, z3::implies(resolveCondition(antecedent, &asgn),
+                                                     resolveCondition(consequent, &asgn))));
+       }
+       return z3::mk_and(z3args);
+   }
+
+
 template<typename ID>
 bool TranslatorZ3<ID>::isSAT() {
 
-    return solver->check() == z3::sat;
+    return resolve() == z3::sat;
 }
 
 
@@ -384,15 +2097,84 @@ const ID TranslatorZ3<ID>::getComponent(const z3::expr &variable) const {
     //return components.getComponent(variable);
 }
 
+template<typename ID>
+typename TranslatorZ3<ID>::Interpretations TranslatorZ3<ID>::getInterpretations(const z3::model &m) const {
+
+    // the model holds a reference to every interpretation while it lives
+    Interpretations values(declCount, nullptr);
+
+    for(unsigned i = 0; i < m.num_consts(); i++) {
+        const z3::func_decl decl = m.get_const_decl(i);
+        if(decl.id() >= declBase && decl.id() - declBase < declCount)
+            values[decl.id() - declBase] = m.get_const_interp(decl);
+    }
+
+    return values;
+}
+
+template<typename ID>
+z3::expr TranslatorZ3<ID>::getValue(const z3::model &m, const Interpretations &values, const z3::expr &e) const {
+
+    if(e.is_const() && e.decl().decl_kind() == Z3_OP_UNINTERPRETED) {
+        const unsigned id = e.decl().id();
+        if(id >= declBase && id - declBase < declCount && values[id - declBase])
+            return z3::expr(m.ctx(), values[id - declBase]);
+    }
+
+    // constants the model leaves open and everything that is not a constant
+    return m.eval(e, true);
+}
+
+template<typename ID>
+const ID TranslatorZ3<ID>::getComponent(const z3::model &m, const Interpretations &values, const ID &assignment, const ID &componentSlot) const {
+
+    const ID &type = problem.getAssignment(assignment).getSlot(componentSlot).type;
+
+    if(sorts.getEncoding(type) != SORT_ENCODING::ONE_HOT)
+        return sorts.getComponent(type, getValue(m, values, getVariable(assignment, componentSlot)));
+
+    const z3::expr_vector &indicators = slots.getIndicators(assignment, componentSlot);
+    for(unsigned i = 0; i < indicators.size(); i++)
+        if(getValue(m, values, indicators[i]).is_true())
+            return sorts.getComponent(type, size_t{i});
+
+    assert(false && "one-hot slot without a set indicator");
+    return sorts.getComponent(type, size_t{0});
+}
+
+template<typename ID>
+const ID &TranslatorZ3<ID>::readComponent(const z3::model &m, const Interpretations &values, const SlotReader &reader) const {
+
+    const std::vector<ID> &components = sorts.getComponents(reader.type);
+
+    if(!reader.oneHot)
+        return components.at(sorts.getOrdinal(reader.type, getValue(m, values, reader.exprs.front())));
+
+    for(size_t i = 0; i < reader.exprs.size(); i++)
+        if(getValue(m, values, reader.exprs.at(i)).is_true())
+            return components.at(i);
+
+    assert(false && "one-hot slot without a set indicator");
+    return components.at(0);
+}
+
 
 template<typename ID>
 z3::expr TranslatorZ3<ID>::resolveComponentIs(const std::shared_ptr<Condition <ID>> &condition,
                                                         const Assignment<ID> *asgn) {
 
     auto c = std::dynamic_pointer_cast<ComponentIs<ID>>(condition);                                                        
-    const z3::expr &component = getConstant(c->component);
-    const z3::expr &var = getVariable(asgn->getID(), c->componentSlot);
-    return var == component;
+
+    // on the top level the condition holds for every assignment with this slot
+    if(!asgn) {
+        z3::expr_vector all {context};
+        for(const auto &[id, a] : problem.getAssignments())
+            if(a.getComponentSlots().count(c->componentSlot))
+                all.push_back(ifActive(id, isComponent(id, c->componentSlot, c->component)));
+        return z3::mk_and(all);
+    }
+
+    return isComponent(asgn->getID(), c->componentSlot, c->component);
 
 }
 
@@ -418,37 +2200,42 @@ z3::expr TranslatorZ3<ID>::resolveSameComponent(const std::shared_ptr<Condition
     for(auto it1 = asgnComb.begin(); it1 != asgnComb.end(); it1++)
         for(auto it2 = std::next(it1); it2 != asgnComb.end(); it2++) {
 
-            const z3::expr &var1 = getVariable((*it1)->getID(), c->slot);
-            const z3::expr &var2 = getVariable((*it2)->getID(), c->slot);
-            equalities.push_back(var1 == var2);
+            equalities.push_back(isSameComponent((*it1)->getID(), (*it2)->getID(), c->slot));
         }
     return z3::mk_and(equalities);
 }
 
 template<typename ID>
-z3::expr TranslatorZ3<ID>::resolveInGroup(const std::shared_ptr<Condition <ID>> &condition, const std::vector<Assignment<ID>*> &asgnComb) {
+z3::expr TranslatorZ3<ID>::resolveInGroup(const std::shared_ptr<Condition <ID>> &condition, const Assignment<ID> *asgn) {
 
     auto c = std::dynamic_pointer_cast<InGroup<ID>>(condition);  
     /*
-     * InGroup(const ID &componentType, ID groupID) : slot{slot}, group{groupID} {}
+     * InGroup(const ID &componentSlot, ID groupID) : slot{componentSlot}, group{groupID} {}
         static const CONDITION_TYPE type = CONDITION_TYPE::IN_GROUP;
         const ID slot;
         const ID group;
      */
 
-    const z3::expr &var = getVariable(asgnComb.at(0)->getID(), c->slot);
+    // on the top level the condition holds for every assignment with this slot
+    if(!asgn) {
+        z3::expr_vector all {context};
+        for(const auto &[id, a] : problem.getAssignments())
+            if(a.getComponentSlots().count(c->slot))
+                all.push_back(ifActive(id, resolveInGroup(condition, &a)));
+        return z3::mk_and(all);
+    }
+
+    const ID &asgnID = asgn->getID();
     // limits domain
     // get slot type
-    const ID &type = asgnComb.at(0)->getSlot(c->slot).type;
+    const ID &type = asgn->getSlot(c->slot).type;
 
     // std::map<ID, std::vector<Component<ID>>> components;
     z3::expr_vector equalities (context);
     for(const auto &component : this->problem.getComponents(type)){
 
-        if(component->inGroup(c->group)) {
-            const z3::expr &comp = getConstant(component->getID());
-            equalities.push_back( var == comp );
-        }
+        if(component->inGroup(c->group))
+            equalities.push_back(isComponent(asgnID, c->slot, component->getID()));
 
     }
     return z3::mk_or(equalities);
@@ -481,16 +2268,11 @@ z3::expr TranslatorZ3::resolveMaxAssignments(const std::shared_ptr<MaxAssignment
 
         // for all assignments in problem
         // this slot is distinct
-        z3::expr_vector vars {context};
+        std::vector<ID> asgns;
         for(const auto &asgn : problem.getAssignments())
-            vars.push_back(slots.getVariable(asgn.first, c->componentSlot));
-
-        z3::expr dis {context};
-        if(!vars.empty())
-            dis = z3::distinct(vars);
-
+            asgns.push_back(asgn.first);
 
-        return dis;
+        return isDistinct(asgns, c->componentSlot);
 
     }
 
@@ -526,9 +2308,9 @@ z3::expr TranslatorZ3::resolveMaxAssignments(const std::shared_ptr<MaxAssignment
         for(auto itf = order.begin(); itf != order.end() - 2; itf++)
             for(auto itb = order.end() - 1; itb > itf+1; itb--)
                 for(auto itbet = itf + 1; itbet != itb; itbet++) {
-                    auto if_first = resolveCondition(subcon, &problem.getAssignment(itf->second));
-                    auto if_second = resolveCondition(subcon, &problem.getAssignment(itb->second));
-                    auto then = resolveCondition(subcon, &problem.getAssignment(itbet->second));
+                    auto if_first = isActive(itf->second) && resolveCondition(subcon, &problem.getAssignment(itf->second));
+                    auto if_second = isActive(itb->second) && resolveCondition(subcon, &problem.getAssignment(itb->second));
+                    auto then = isActive(itbet->second) && resolveCondition(subcon, &problem.getAssignment(itbet->second));
                     v.push_back(z3::implies(if_first && if_second, then));
                 }
 
@@ -572,7 +2354,7 @@ z3::expr TranslatorZ3::resolveMaxAssignments(const std::shared_ptr<MaxAssignment
         for(const auto &[id1, asgn1] : problem.getAssignments())
             for(const auto &[id2, asgn2] : problem.getAssignments())
                 if(asgn1.getSlot(namedSlot).component < asgn2.getSlot(namedSlot).component)
-                    v.push_back((!(resolveCondition(greaterCond, &asgn1))) || !(resolveCondition(smallerCond, &asgn2)));
+                    v.push_back(!(isActive(id1) && resolveCondition(greaterCond, &asgn1)) || !(isActive(id2) && resolveCondition(smallerCond, &asgn2)));
 
         return z3::mk_and(v);
     }
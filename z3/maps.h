@@ -7,45 +7,108 @@
 
 #include <z3.h>
 #include <z3++.h>
+#include <algorithm>
 #include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "OptionsZ3.h"
 
 namespace omtsched {
 
     /*
     * z3::sort does not define an order so boost::bimap cannot be used directly
     * This is a simple wrapper to circumvent that issue.
+    *
+    * Every component type is represented according to its SORT_ENCODING.
+    * Independent of the encoding, each component has an ordinal, its position
+    * within the components of its type. One-hot types have no constants.
     */
     template<typename ID>
     struct SortMap {
 
     public:
-        SortMap(z3::context &context, const Problem<ID> &problem);
+        SortMap(z3::context &context, const Problem<ID> &problem, const OptionsZ3<ID> &options);
+
+        // the decoders point into the maps
+        SortMap(const SortMap &) = delete;
+        SortMap &operator=(const SortMap &) = delete;
 
         const z3::sort &getSort(const ID &type) const;
 
+        SORT_ENCODING getEncoding(const ID &type) const;
+
         const z3::expr &getConstant(const ID &) const;
 
+        size_t getOrdinal(const ID &component) const;
+
+        size_t getSize(const ID &type) const;
+
         const ID &getComponent(const z3::expr &) const;
 
+        const ID &getComponent(const ID &type, const z3::expr &value) const;
+
+        const ID &getComponent(const ID &type, const size_t &ordinal) const;
+
+        // the position of the type among the problem's types, for the lookups by index below
+        size_t getTypeIndex(const ID &type) const;
+
+        /**
+         * @param value the interpretation of a slot of the type in a model
+         * @return the ordinal of the component, without a search for enumerations, bit-vectors and dense integers
+         */
+        size_t getOrdinal(const size_t &typeIndex, const z3::expr &value) const;
+
+        const std::vector<ID> &getComponents(const size_t &typeIndex) const;
+
         void print() const;
 
     private:
 
+        // reads the values of a type in a model as ordinals
+        struct Decoder {
+            SORT_ENCODING encoding;
+            const std::vector<ID> *components;
+            // ENUMERATION: ordinal by AST id - base, INTEGER: ordinal by value - base,
+            // empty if the values are too sparse, which are then looked up in valueMap
+            int64_t base = 0;
+            std::vector<size_t> ordinals;
+            const std::map<int64_t, size_t> *values = nullptr;
+        };
+
+        void makeDecoder(const ID &type);
+
+        void makeEnumeration(const ID &type, const std::string &name);
+        void makeBitVector(const ID &type);
+        void makeInteger(const ID &type);
+
         const Problem<ID> &problem;
         z3::context &context;
 
+        std::map<ID, SORT_ENCODING> encodingMap;
         std::map<ID, z3::sort> sortMap;
 
         std::map<ID, z3::expr> constantMap;
         std::map<unsigned, ID> componentMap;
 
+        // component -> ordinal and (type, ordinal) -> component
+        std::map<ID, size_t> ordinalMap;
+        std::map<ID, std::vector<ID>> typeComponents;
+
+        // integer value -> ordinal, only used for the INTEGER encoding
+        std::map<ID, std::map<int64_t, size_t>> valueMap;
+
         std::vector<z3::func_decl_vector> enum_consts;
         std::vector<z3::func_decl_vector> enum_testers;
 
+        std::vector<Decoder> decoders;
+        std::map<ID, size_t> typeIndices;
+
+        static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
     };
 
     template<typename ID>
-    SortMap<ID>::SortMap(z3::context &context, const Problem<ID> &problem) : context{context}, problem{problem} {
+    SortMap<ID>::SortMap(z3::context &context, const Problem<ID> &problem, const OptionsZ3<ID> &options) : problem{problem}, context{context} {
 
         int typeCount = 0;
 
@@ -53,58 +116,242 @@ namespace omtsched {
 
             std::string name = "s" + std::to_string(typeCount);
 
-            enum_consts.emplace_back(context);
-            enum_testers.emplace_back(context);
+            auto &ordinals = typeComponents[type];
+            for(const auto &component : this->problem.getComponents(type)) {
+                ordinalMap.emplace(component->getID(), ordinals.size());
+                ordinals.push_back(component->getID());
+            }
 
-            const auto &names = this->problem.getComponents(type);
+            const SORT_ENCODING encoding = options.getEncoding(type);
+            encodingMap.emplace(type, encoding);
 
-            // create array needed for enum type
-            char * enum_names [names.size()];
-            for(int i = 0; i < names.size(); i++) {
+            switch (encoding) {
 
-                std::string comp_name = name + "_c" + std::to_string(i);
-                enum_names[i] = new char;
-                std::strcpy(enum_names[i], comp_name.data());
+                case SORT_ENCODING::ENUMERATION:
+                    makeEnumeration(type, name);
+                    break;
 
-            }
+                case SORT_ENCODING::BITVECTOR:
+                    makeBitVector(type);
+                    break;
 
-            // make sort
-            z3::sort sort = context.enumeration_sort(name.data(), names.size(), enum_names, enum_consts.back(), enum_testers.back());
-            sortMap.emplace(type, sort);
-
-            for(char * pointer : enum_names)
-                delete pointer;
-
-            // save components
-            size_t i = 0;
-            for(const auto &component : names) {
-                const ID &id = component->getID();
-                z3::expr expr = enum_consts.back()[i]();
-                constantMap.emplace(id, expr);
-                componentMap.emplace(expr.id(), id);
-                i++;
+                case SORT_ENCODING::INTEGER:
+                    makeInteger(type);
+                    break;
+
+                case SORT_ENCODING::ONE_HOT:
+                    // indicators are created per slot by the SlotMap
+                    sortMap.emplace(type, context.bool_sort());
+                    break;
             }
 
+            makeDecoder(type);
             typeCount++;
 
         }
     };
 
+    template<typename ID>
+    void SortMap<ID>::makeEnumeration(const ID &type, const std::string &name) {
+
+        enum_consts.emplace_back(context);
+        enum_testers.emplace_back(context);
+
+        const auto &names = this->problem.getComponents(type);
+
+        // create array needed for enum type
+        std::vector<std::string> comp_names;
+        comp_names.reserve(names.size());
+        for(size_t i = 0; i < names.size(); i++)
+            comp_names.push_back(name + "_c" + std::to_string(i));
+
+        std::vector<const char *> enum_names;
+        enum_names.reserve(comp_names.size());
+        for(const std::string &comp_name : comp_names)
+            enum_names.push_back(comp_name.c_str());
+
+        // make sort
+        z3::sort sort = context.enumeration_sort(name.data(), enum_names.size(), enum_names.data(), enum_consts.back(), enum_testers.back());
+        sortMap.emplace(type, sort);
+
+        // save components
+        size_t i = 0;
+        for(const auto &component : names) {
+            const ID &id = component->getID();
+            z3::expr expr = enum_consts.back()[i]();
+            constantMap.emplace(id, expr);
+            componentMap.emplace(expr.id(), id);
+            i++;
+        }
+    }
+
+    template<typename ID>
+    void SortMap<ID>::makeBitVector(const ID &type) {
+
+        const auto &components = this->problem.getComponents(type);
+
+        // log-size: smallest width that can hold every ordinal
+        unsigned width = 1;
+        while(width < 64 && (uint64_t{1} << width) < components.size())
+            width++;
+
+        sortMap.emplace(type, context.bv_sort(width));
+
+        for(const auto &component : components)
+            constantMap.emplace(component->getID(), context.bv_val(uint64_t{ordinalMap.at(component->getID())}, width));
+    }
+
+    template<typename ID>
+    void SortMap<ID>::makeInteger(const ID &type) {
+
+        const auto &components = this->problem.getComponents(type);
+        auto &values = valueMap[type];
+
+        // ordered components keep their value so that arithmetic on the slot is meaningful,
+        // otherwise (or if two components share a value) the ordinal is used
+        bool ordered = true;
+        for(const auto &component : components) {
+            auto oc = std::dynamic_pointer_cast<OrderedComponent<ID>>(component);
+            if(!oc || !values.emplace(oc->getValue(), ordinalMap.at(component->getID())).second) {
+                ordered = false;
+                break;
+            }
+        }
+
+        if(!ordered) {
+            values.clear();
+            for(const auto &component : components)
+                values.emplace(ordinalMap.at(component->getID()), ordinalMap.at(component->getID()));
+        }
+
+        sortMap.emplace(type, context.int_sort());
+
+        for(const auto &[value, ordinal] : values)
+            constantMap.emplace(typeComponents.at(type).at(ordinal), context.int_val(value));
+    }
+
+    template<typename ID>
+    void SortMap<ID>::makeDecoder(const ID &type) {
+
+        Decoder decoder;
+        decoder.encoding = encodingMap.at(type);
+        decoder.components = &typeComponents.at(type);
+
+        const std::vector<ID> &components = typeComponents.at(type);
+
+        // enumeration constants are created together, so their AST ids are close to each other
+        if(decoder.encoding == SORT_ENCODING::ENUMERATION && !components.empty()) {
+
+            std::vector<unsigned> ids;
+            for(const ID &component : components)
+                ids.push_back(constantMap.at(component).id());
+
+            decoder.base = *std::min_element(ids.begin(), ids.end());
+            decoder.ordinals.assign(*std::max_element(ids.begin(), ids.end()) - decoder.base + 1, NONE);
+            for(size_t ordinal = 0; ordinal < ids.size(); ordinal++)
+                decoder.ordinals.at(ids.at(ordinal) - decoder.base) = ordinal;
+        }
+
+        if(decoder.encoding == SORT_ENCODING::INTEGER && !components.empty()) {
+
+            const std::map<int64_t, size_t> &values = valueMap.at(type);
+            decoder.values = &values;
+
+            // values of ordered components may be far apart, a table is only used if it stays small
+            const int64_t lowest = values.begin()->first;
+            const int64_t highest = values.rbegin()->first;
+            if((uint64_t) (highest - lowest) < 4 * values.size() + 64) {
+                decoder.base = lowest;
+                decoder.ordinals.assign(highest - lowest + 1, NONE);
+                for(const auto &[value, ordinal] : values)
+                    decoder.ordinals.at(value - lowest) = ordinal;
+            }
+        }
+
+        typeIndices.emplace(type, decoders.size());
+        decoders.push_back(std::move(decoder));
+    }
+
     template<typename ID>
     const z3::sort &SortMap<ID>::getSort(const ID &type) const {
         return sortMap.at(type);
     }
 
+    template<typename ID>
+    SORT_ENCODING SortMap<ID>::getEncoding(const ID &type) const {
+        return encodingMap.at(type);
+    }
+
     template<typename ID>
     const z3::expr &SortMap<ID>::getConstant(const ID &id) const {
         return constantMap.at(id);
     }
 
+    template<typename ID>
+    size_t SortMap<ID>::getOrdinal(const ID &component) const {
+        return ordinalMap.at(component);
+    }
+
+    template<typename ID>
+    size_t SortMap<ID>::getSize(const ID &type) const {
+        return typeComponents.at(type).size();
+    }
+
     template<typename ID>
     const ID &SortMap<ID>::getComponent(const z3::expr &expr) const {
         return componentMap.at(expr.id());
     }
 
+    template<typename ID>
+    const ID &SortMap<ID>::getComponent(const ID &type, const z3::expr &value) const {
+
+        const size_t typeIndex = getTypeIndex(type);
+        return getComponents(typeIndex).at(getOrdinal(typeIndex, value));
+    }
+
+    template<typename ID>
+    size_t SortMap<ID>::getTypeIndex(const ID &type) const {
+        return typeIndices.at(type);
+    }
+
+    template<typename ID>
+    size_t SortMap<ID>::getOrdinal(const size_t &typeIndex, const z3::expr &value) const {
+
+        const Decoder &decoder = decoders.at(typeIndex);
+
+        switch (decoder.encoding) {
+
+            case SORT_ENCODING::ENUMERATION:
+                return decoder.ordinals.at(value.id() - decoder.base);
+
+            case SORT_ENCODING::BITVECTOR:
+                return value.get_numeral_uint64();
+
+            case SORT_ENCODING::INTEGER: {
+                const int64_t number = value.get_numeral_int64();
+                if(decoder.ordinals.empty())
+                    return decoder.values->at(number);
+                return decoder.ordinals.at(number - decoder.base);
+            }
+
+            // the value of a one-hot slot is spread over its indicators
+            case SORT_ENCODING::ONE_HOT:
+                throw std::logic_error("one-hot slots have no single value");
+        }
+
+        throw std::logic_error("unknown sort encoding");
+    }
+
+    template<typename ID>
+    const std::vector<ID> &SortMap<ID>::getComponents(const size_t &typeIndex) const {
+        return *decoders.at(typeIndex).components;
+    }
+
+    template<typename ID>
+    const ID &SortMap<ID>::getComponent(const ID &type, const size_t &ordinal) const {
+        return typeComponents.at(type).at(ordinal);
+    }
+
     template<typename ID>
     void SortMap<ID>::print() const {
 
@@ -139,12 +386,16 @@ namespace omtsched {
 
         const z3::expr &getVariable(const ID &, const ID &) const;
 
+        const z3::expr_vector &getIndicators(const ID &, const ID &) const;
+
         const std::pair<ID, ID> &getSlot(const z3::expr &) const;
 
         void print() const;
 
     private:
         std::map<std::pair<ID, ID>, z3::expr> variableMap;
+        // one-hot slots: indicator i is true iff the slot holds the component with ordinal i
+        std::map<std::pair<ID, ID>, z3::expr_vector> indicatorMap;
         std::map<std::string, std::pair<ID, ID>> slotMap;
 
     };
@@ -157,10 +408,19 @@ namespace omtsched {
             int c = 0;
             for (const auto &[sid, slot] : assignment.getComponentSlots()) {
                 // create assignment variable
-                const z3::sort &type = sorts.getSort(slot.type);
-                const std::string &name = "a" + std::to_string(a) + "c" + sid;
-                variableMap.emplace(std::make_pair(assignment.getID(), sid), context.constant(name.c_str(), type));
+                const std::string &name = "a" + std::to_string(a) + "c" + std::to_string(c);
                 slotMap.emplace(name, std::make_pair(assignment.getID(), sid));
+
+                if(sorts.getEncoding(slot.type) == SORT_ENCODING::ONE_HOT) {
+                    z3::expr_vector indicators {context};
+                    for(size_t i = 0; i < sorts.getSize(slot.type); i++)
+                        indicators.push_back(context.bool_const((name + "_" + std::to_string(i)).c_str()));
+                    indicatorMap.emplace(std::make_pair(assignment.getID(), sid), indicators);
+                }
+                else {
+                    const z3::sort &type = sorts.getSort(slot.type);
+                    variableMap.emplace(std::make_pair(assignment.getID(), sid), context.constant(name.c_str(), type));
+                }
                 c++;
             }
             a++;
@@ -172,6 +432,11 @@ namespace omtsched {
         return variableMap.at(std::make_pair(assignment, slot));
     }
 
+    template<typename ID>
+    const z3::expr_vector &SlotMap<ID>::getIndicators(const ID &assignment, const ID &slot) const {
+        return indicatorMap.at(std::make_pair(assignment, slot));
+    }
+
     template<typename ID>
     const std::pair<ID, ID> &SlotMap<ID>::getSlot(const z3::expr &expr) const {
         return slotMap.at(expr.get_string());
@@ -190,6 +455,9 @@ namespace omtsched {
         for(const auto &[pair, expr] : variableMap)
             std::cout << "ID: " << pair.first << ", " << pair.second << " Value: " << expr << std::endl;
 
+        for(const auto &[pair, indicators] : indicatorMap)
+            std::cout << "ID: " << pair.first << ", " << pair.second << " Value: " << indicators << std::endl;
+
         std::cout << std::endl << "Slots:" <<   std::endl;
 
         for(const auto &[name, pair] : slotMap)